@@ -4,12 +4,15 @@
 #include <hpx/hpx.hpp>
 #include <hpx/hpx_init.hpp>
 #include <hpx/include/partitioned_vector.hpp>
+#include <hpx/modules/collectives.hpp>
 #include <hpx/modules/program_options.hpp>
 #include <cstddef>
 #include <cstdlib>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <hpx/iostream.hpp>
@@ -89,54 +92,187 @@ private:
     local_segment_iterator segment_iterator_;
 };
 ///////////////////////////////////////////////////////////////////////////////
+//
+// Exclusive scan of one value per locality (the carry-in of every locality).
+//
+// Every locality contributes the sum of its own segment and gets back the
+// combined sums of all localities with a lower id. The values are exchanged
+// point-to-point over a channel_communicator, so no global barrier and no
+// remote partitioned_vector access is involved.
+//
+// Situation example (3 Localities, local sums 10 10 10):
+// L0 carry 0
+// L1 carry    10
+// L2 carry       20
+//
+enum class carry_algorithm
+{
+    linear,                // chain L0 -> L1 -> ... -> Ln-1, n-1 hops
+    recursive_doubling,    // Hillis-Steele over localities, log2(n) rounds
+    tree                   // binomial up-sweep and down-sweep, 2*log2(n) hops
+};
+
+carry_algorithm parse_carry_algorithm(std::string const& name)
+{
+    if (name == "linear")
+        return carry_algorithm::linear;
+    if (name == "recursive_doubling")
+        return carry_algorithm::recursive_doubling;
+    if (name == "tree")
+        return carry_algorithm::tree;
+    throw std::invalid_argument("unknown carry_algorithm: " + name);
+}
+
+// Every scan round gets its own range of channel tags, so messages of
+// consecutive rounds can never be mixed up. The down-sweep of the tree uses
+// the upper half of the range.
+constexpr std::size_t carry_tags_per_round = 128;
+constexpr std::size_t carry_down_sweep_tag = 64;
+
+inline hpx::collectives::tag_arg carry_tag(std::size_t generation, std::size_t step)
+{
+    return hpx::collectives::tag_arg(generation * carry_tags_per_round + step);
+}
+
+// The returned value is the carry-in of this locality. Outgoing messages are
+// appended to pending_sends and have to be waited for by the caller; they are
+// not waited for here so they never sit on the critical path of the caller.
+template <typename T, typename Op>
+T exclusive_scan_localities(hpx::collectives::channel_communicator comm,
+    std::size_t num_localities, std::size_t this_locality, T const& local,
+    T const& identity, Op&& op, carry_algorithm algorithm,
+    std::size_t generation, std::vector<hpx::future<void>>& pending_sends)
+{
+    using hpx::collectives::get;
+    using hpx::collectives::set;
+    using hpx::collectives::that_site_arg;
+
+    T carry = identity;
+
+    switch (algorithm)
+    {
+    case carry_algorithm::linear:
+    {
+        if (this_locality != 0)
+        {
+            carry = get<T>(comm, that_site_arg(this_locality - 1),
+                carry_tag(generation, 0)).get();
+        }
+        if (this_locality + 1 != num_localities)
+        {
+            pending_sends.push_back(set(comm, that_site_arg(this_locality + 1),
+                T(op(carry, local)), carry_tag(generation, 0)));
+        }
+        break;
+    }
+
+    case carry_algorithm::recursive_doubling:
+    {
+        // after round k, inclusive holds the combined values of
+        // [this_locality - 2^(k+1) + 1, this_locality]
+        T inclusive = local;
+        std::size_t step = 0;
+        for (std::size_t d = 1; d < num_localities; d <<= 1, ++step)
+        {
+            if (this_locality + d < num_localities)
+            {
+                pending_sends.push_back(set(comm, that_site_arg(this_locality + d),
+                    T(inclusive), carry_tag(generation, step)));
+            }
+            if (this_locality >= d)
+            {
+                T received = get<T>(comm, that_site_arg(this_locality - d),
+                    carry_tag(generation, step)).get();
+                carry = op(received, carry);
+                inclusive = op(received, inclusive);
+            }
+        }
+        break;
+    }
+
+    case carry_algorithm::tree:
+    {
+        // up-sweep: the locality is the root of the subtree
+        // [this_locality, this_locality + 2^k) for every k below its level,
+        // partials[k] holds the combined values of that subtree
+        std::vector<T> partials;
+        T total = local;
+        std::size_t level = 0;
+        std::size_t d = 1;
+        for (; d < num_localities; d <<= 1, ++level)
+        {
+            if (this_locality % (2 * d) != 0)
+            {
+                // hand the total of the own subtree to the parent
+                pending_sends.push_back(set(comm, that_site_arg(this_locality - d),
+                    T(total), carry_tag(generation, level)));
+                break;
+            }
+            partials.push_back(total);
+            if (this_locality + d < num_localities)
+            {
+                total = op(total, get<T>(comm, that_site_arg(this_locality + d),
+                    carry_tag(generation, level)).get());
+            }
+        }
+
+        // down-sweep: receive the carry from the parent and pass the carry of
+        // every child on (the largest subtree first)
+        if (this_locality != 0)
+        {
+            carry = get<T>(comm, that_site_arg(this_locality - d),
+                carry_tag(generation, carry_down_sweep_tag + level)).get();
+        }
+        for (std::size_t k = partials.size(); k-- != 0;)
+        {
+            std::size_t child = this_locality + (std::size_t(1) << k);
+            if (child < num_localities)
+            {
+                pending_sends.push_back(set(comm, that_site_arg(child),
+                    T(op(carry, partials[k])),
+                    carry_tag(generation, carry_down_sweep_tag + k)));
+            }
+        }
+        break;
+    }
+    }
+
+    return carry;
+}
+///////////////////////////////////////////////////////////////////////////////
 int hpx_main(hpx::program_options::variables_map& vm)
 {
     VALUETYPE size = 15;
     if (vm.count("maxelems"))
         size = vm["maxelems"].as<VALUETYPE>();
+    carry_algorithm algorithm =
+        parse_carry_algorithm(vm["carry_algorithm"].as<std::string>());
+    
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const this_locality = hpx::get_locality_id();
     
     //print vector size
-    if (0 == hpx::get_locality_id())
+    if (0 == this_locality)
     {
         std::cout << "Scan Vector Size: " << size << std::endl;
     }
     
     char const* const vector_name_1 =
         "partitioned_vector_1";
-    char const* const vector_name_2 =
-        "partitioned_vector_2";
-    char const* const latch_reduction_name = "latch_reduction_name";
-    char const* const latch_first_scan_name = "latch_first_scan_name";
-    char const* const latch_shifted_sums_name = "latch_shifted_sums_name";
+    char const* const carry_channel_name = "scan_carry_channel";
     char const* const latch_transform_main_vector_name = "latch_transform_main_vector_name";
     
     {
         // create vector on one locality, connect to it from all others
         hpx::partitioned_vector<VALUETYPE> main_vector;
-        hpx::partitioned_vector<VALUETYPE> sums_per_locality;
-        hpx::distributed::latch latch_reduction;
-        hpx::distributed::latch latch_first_scan;
-        hpx::distributed::latch latch_shifted_sums;
         hpx::distributed::latch latch_transform_main_vector;
         
-        if (0 == hpx::get_locality_id())
+        if (0 == this_locality)
         {
             std::vector<hpx::id_type> localities = hpx::find_all_localities();
             
             main_vector = hpx::partitioned_vector<VALUETYPE>(size, hpx::container_layout(localities));
             main_vector.register_as(vector_name_1);
- 
-            sums_per_locality = hpx::partitioned_vector<VALUETYPE>(localities.size(), hpx::container_layout(localities));
-            sums_per_locality.register_as(vector_name_2);
-            
-            latch_reduction = hpx::distributed::latch(localities.size());
-            latch_reduction.register_as(latch_reduction_name);
-            
-            latch_first_scan = hpx::distributed::latch(localities.size());
-            latch_first_scan.register_as(latch_first_scan_name);
-            
-            latch_shifted_sums = hpx::distributed::latch(localities.size());
-            latch_shifted_sums.register_as(latch_shifted_sums_name);
             
             latch_transform_main_vector = hpx::distributed::latch(localities.size());
             latch_transform_main_vector.register_as(latch_transform_main_vector_name);
@@ -144,14 +280,16 @@ int hpx_main(hpx::program_options::variables_map& vm)
         else
         {
             hpx::future<void> f1 = main_vector.connect_to(vector_name_1);
-            hpx::future<void> f2 = sums_per_locality.connect_to(vector_name_2);
-            latch_reduction.connect_to(latch_reduction_name);
-            latch_first_scan.connect_to(latch_first_scan_name);
-            latch_shifted_sums.connect_to(latch_shifted_sums_name);
             latch_transform_main_vector.connect_to(latch_transform_main_vector_name);
             f1.get();
-            f2.get();
         }
+        
+        // point-to-point channels between all localities for the carry-in exchange
+        hpx::collectives::channel_communicator carry_comm =
+            hpx::collectives::create_channel_communicator(hpx::launch::sync,
+                carry_channel_name,
+                hpx::collectives::num_sites_arg(num_localities),
+                hpx::collectives::this_site_arg(this_locality));
  
         // fill the partitioned vector main_vector with numbers 2 per locality
         partitioned_vector_view<VALUETYPE> main_vector_view(main_vector);
@@ -165,57 +303,36 @@ int hpx_main(hpx::program_options::variables_map& vm)
         // L2 main_vector_view(5)                     2 2 2 2 2
         // main_vector:           2 2 2 2 2 2 2 2 2 2 2 2 2 2 2
         
-        // reduce per locality the main_vector entries and save it via sums_per_locality_view:
-        partitioned_vector_view<VALUETYPE> sums_per_locality_view(sums_per_locality);
+        // reduce per locality the main_vector entries:
         VALUETYPE result = hpx::reduce(hpx::execution::par, main_vector_view.begin() , main_vector_view.end());
-        sums_per_locality_view[0] = result;
         
-        // Situation example (sums_per_locality):
-        // 3 Localities (Lx):
-        // L0 sums_per_locality_view[0]        10
-        // L1 sums_per_locality_view[0]           10
-        // L2 sums_per_locality_view[0]              10
-        // sums_per_locality:                  10 10 10
-        
-        // Wait for all localities to reach this point.
-        latch_reduction.arrive_and_wait();
+        // get the sum of all lower localities directly from them
+        // (L0: 0, L1: 10, L2: 20 in the example above):
+        std::vector<hpx::future<void>> pending_sends;
+        VALUETYPE carry = exclusive_scan_localities(carry_comm, num_localities, this_locality,
+            result, VALUETYPE(0), std::plus<VALUETYPE>(), algorithm, 1, pending_sends);
  
         // make an inclusive_scan on the main_vector_view:
         hpx::inclusive_scan(hpx::execution::par, main_vector_view.begin(), main_vector_view.end(), main_vector_view.begin());
         
-        // Wait for all localities to reach this point.
-        latch_first_scan.arrive_and_wait();
-        
         // Situation example after inclusive_scan (main_vector):
         // 3 Localities (Lx):
         // L0 main_vector_view(5) 2 4 6 8 10
         // L1 main_vector_view(5)            2 4 6 8 10
         // L2 main_vector_view(5)                       2 4 6 8 10
         // main_vector:           2 4 6 8 10 2 4 6 8 10 2 4 6 8 10
-
-	
-        if (0 == hpx::get_locality_id())
+        
+        if (0 != this_locality)
         {
-            //sums_per_locality: 10 10 10 --> has to be changed to 10 20 30 via inclusive_scan:
-            hpx::inclusive_scan(hpx::execution::par, sums_per_locality.begin(), sums_per_locality.end(), sums_per_locality.begin());
+            // function to add the carry-in to the main_vector_view value --> for example: Locality 1 values in main_vector_view and on every value, we add a 20, that a "2" is changed to "22"
+            auto add_single_value = [&](VALUETYPE input_value) {return input_value + carry;};
+            hpx::transform(hpx::execution::par, main_vector_view.begin(), main_vector_view.end(), main_vector_view.begin(), add_single_value);
             
-            //now we have to shift_right the transformed sums_per_locality --> from 10 20 30 to 10 10 20 (first 10 is indifferent):
-            for (VALUETYPE i = sums_per_locality.size()-1; i != 0; --i)
-            {
-                 VALUETYPE x = sums_per_locality[i-1];
-                 sums_per_locality[i] = x;
-            }
         }
         
-        // Wait for all localities to reach this point.
-        latch_shifted_sums.arrive_and_wait();
-        
-        if (0 != hpx::get_locality_id())
+        for (auto& f : pending_sends)
         {
-            // function to add the specific value of sums_per_locality_view to the main_vector_view value --> for example: Locality 1 values in main_vector_view and on every value, we add a 20, that a "2" is changed to "22"
-            auto add_single_value = [&](VALUETYPE input_value) {return input_value + sums_per_locality_view[0];};
-            hpx::transform(hpx::execution::par, main_vector_view.begin(), main_vector_view.end(), main_vector_view.begin(), add_single_value);
-            
+            f.get();
         }
  
         // Wait for all localities to reach this point.
@@ -237,6 +354,8 @@ int main(int argc, char* argv[])
     desc_commandline.add_options()
         ("maxelems,m", value<VALUETYPE>(),
             "the data array size to use (default: 15)")
+        ("carry_algorithm", value<std::string>()->default_value("tree"),
+            "cross-locality exclusive scan: linear, recursive_doubling or tree")
         ;
     // clang-format on
  
@@ -0,0 +1,607 @@
+#include <hpx/config.hpp>
+#if !defined(HPX_COMPUTE_DEVICE_CODE)
+#include <hpx/algorithm.hpp>
+#include <hpx/hpx.hpp>
+#include <hpx/hpx_init.hpp>
+#include <hpx/include/partitioned_vector.hpp>
+#include <hpx/iterator_support/counting_iterator.hpp>
+#include <hpx/modules/collectives.hpp>
+#include <hpx/modules/program_options.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <hpx/iostream.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+using VALUETYPE = float;
+
+// records per block of the AoSoA layout, one cache line of VALUETYPE
+constexpr std::size_t block_width = 16;
+
+// a record of Fields fields (array of structs)
+template <std::size_t Fields>
+struct record
+{
+    VALUETYPE field[Fields];
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int)
+    {
+        for (VALUETYPE& value : field)
+            ar & value;
+    }
+};
+
+// block_width records of Fields fields, field by field (array of structs of
+// arrays)
+template <std::size_t Fields>
+struct record_block
+{
+    VALUETYPE field[Fields][block_width];
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int)
+    {
+        for (auto& lanes : field)
+            for (VALUETYPE& value : lanes)
+                ar & value;
+    }
+};
+
+using record4 = record<4>;
+using record8 = record<8>;
+using record16 = record<16>;
+using record_block4 = record_block<4>;
+using record_block8 = record_block<8>;
+using record_block16 = record_block<16>;
+
+// Define the vector types to be used.
+HPX_REGISTER_PARTITIONED_VECTOR(VALUETYPE)
+HPX_REGISTER_PARTITIONED_VECTOR(record4)
+HPX_REGISTER_PARTITIONED_VECTOR(record8)
+HPX_REGISTER_PARTITIONED_VECTOR(record16)
+HPX_REGISTER_PARTITIONED_VECTOR(record_block4)
+HPX_REGISTER_PARTITIONED_VECTOR(record_block8)
+HPX_REGISTER_PARTITIONED_VECTOR(record_block16)
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct partitioned_vector_view
+{
+private:
+    typedef typename hpx::partitioned_vector<T>::iterator global_iterator;
+    typedef typename hpx::partitioned_vector<T>::const_iterator
+        const_global_iterator;
+
+    typedef hpx::traits::segmented_iterator_traits<global_iterator> traits;
+    typedef hpx::traits::segmented_iterator_traits<const_global_iterator>
+        const_traits;
+
+    typedef typename traits::local_segment_iterator local_segment_iterator;
+
+public:
+    typedef typename traits::local_raw_iterator iterator;
+    typedef typename const_traits::local_raw_iterator const_iterator;
+    typedef T value_type;
+
+public:
+    explicit partitioned_vector_view(hpx::partitioned_vector<T>& data)
+      : segment_iterator_(data.segment_begin(hpx::get_locality_id()))
+    {
+    }
+
+    iterator begin()
+    {
+        return traits::begin(segment_iterator_);
+    }
+    iterator end()
+    {
+        return traits::end(segment_iterator_);
+    }
+
+    const_iterator begin() const
+    {
+        return const_traits::begin(segment_iterator_);
+    }
+    const_iterator end() const
+    {
+        return const_traits::end(segment_iterator_);
+    }
+
+    value_type& operator[](std::size_t index)
+    {
+        return (*segment_iterator_)[index];
+    }
+    value_type const& operator[](std::size_t index) const
+    {
+        return (*segment_iterator_)[index];
+    }
+
+    std::size_t size() const
+    {
+        return (*segment_iterator_).size();
+    }
+
+private:
+    local_segment_iterator segment_iterator_;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Record layouts.
+//
+// size records of Fields fields, field k of every record starts with k. The
+// kernels touch the first touched_fields fields of every record:
+// transform: field[k] = field[k] + 1
+// reduce:    sum of field[k] over all records of all localities
+//
+// aos:   one partitioned_vector of records, the fields of a record are
+//        adjacent. Every cache line holding a touched field is transferred
+//        completely, with the untouched fields in it.
+// soa:   one partitioned_vector per field, a kernel streams the touched
+//        fields only.
+// aosoa: one partitioned_vector of blocks of block_width records, every
+//        field of a block is a cache line of its own. The kernels stream the
+//        touched fields only, like soa, from one vector. The last block of a
+//        locality is filled up with records which are processed as well.
+//
+// Bandwidth counts the touched fields only (read and written for transform,
+// read for reduce) of the records of all localities, it is the useful
+// bandwidth of the layout.
+//
+// Situation example (Fields 4, touched_fields 2, 2 records):
+// aos   0 1 2 3 | 0 1 2 3          transform -> 1 2 2 3 | 1 2 2 3
+// soa   0 0 | 1 1 | 2 2 | 3 3      transform -> 1 1 | 2 2 | 2 2 | 3 3
+// reduce: 0 + 1 + 0 + 1 = 2 in both layouts
+//
+enum class record_layout
+{
+    aos,
+    soa,
+    aosoa
+};
+
+record_layout parse_record_layout(std::string const& name)
+{
+    if (name == "aos")
+        return record_layout::aos;
+    if (name == "soa")
+        return record_layout::soa;
+    if (name == "aosoa")
+        return record_layout::aosoa;
+    throw std::invalid_argument("unknown layout: " + name);
+}
+
+enum class layout_kernel
+{
+    transform,
+    reduce
+};
+
+layout_kernel parse_layout_kernel(std::string const& name)
+{
+    if (name == "transform")
+        return layout_kernel::transform;
+    if (name == "reduce")
+        return layout_kernel::reduce;
+    throw std::invalid_argument("unknown layout_kernel: " + name);
+}
+
+// creates vector on one locality, connects to it from all others
+template <typename T>
+hpx::partitioned_vector<T> create_vector(std::size_t size, std::string const& name)
+{
+    hpx::partitioned_vector<T> result;
+    if (0 == hpx::get_locality_id())
+    {
+        std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+        result = hpx::partitioned_vector<T>(
+            size, hpx::container_layout(localities));
+        result.register_as(name);
+    }
+    else
+    {
+        result.connect_to(name).get();
+    }
+    return result;
+}
+
+// The records of the layout in the local parts of its vectors, field k of
+// record i is field(k, i)
+template <std::size_t Fields>
+struct layout_records
+{
+    record_layout layout;
+    std::size_t count;
+    record<Fields>* records;
+    std::array<VALUETYPE*, Fields> fields;
+    record_block<Fields>* blocks;
+
+    VALUETYPE& field(std::size_t k, std::size_t i) const
+    {
+        switch (layout)
+        {
+        case record_layout::aos:
+            return records[i].field[k];
+        case record_layout::soa:
+            return fields[k][i];
+        case record_layout::aosoa:
+        default:
+            return blocks[i / block_width].field[k][i % block_width];
+        }
+    }
+};
+
+// field[k] = field[k] + 1 for the first touched fields of every record
+template <std::size_t Fields>
+void layout_transform(layout_records<Fields> const& r, std::size_t touched)
+{
+    switch (r.layout)
+    {
+    case record_layout::aos:
+    {
+        record<Fields>* const records = r.records;
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), r.count,
+            [=](std::size_t i) {
+                for (std::size_t k = 0; k != touched; ++k)
+                    records[i].field[k] += 1;
+            });
+        break;
+    }
+    case record_layout::soa:
+    {
+        std::array<VALUETYPE*, Fields> const fields = r.fields;
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), r.count,
+            [=](std::size_t i) {
+                for (std::size_t k = 0; k != touched; ++k)
+                    fields[k][i] += 1;
+            });
+        break;
+    }
+    case record_layout::aosoa:
+    default:
+    {
+        record_block<Fields>* const blocks = r.blocks;
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0),
+            r.count / block_width, [=](std::size_t b) {
+                for (std::size_t k = 0; k != touched; ++k)
+                    for (std::size_t l = 0; l != block_width; ++l)
+                        blocks[b].field[k][l] += 1;
+            });
+        break;
+    }
+    }
+}
+
+// sum of the first touched fields of every record
+template <std::size_t Fields>
+double layout_reduce(layout_records<Fields> const& r, std::size_t touched)
+{
+    auto const first = hpx::util::make_counting_iterator(std::size_t(0));
+    switch (r.layout)
+    {
+    case record_layout::aos:
+    {
+        record<Fields> const* const records = r.records;
+        return hpx::transform_reduce(hpx::execution::par, first, first + r.count,
+            0.0, std::plus<double>(), [=](std::size_t i) {
+                double sum = 0;
+                for (std::size_t k = 0; k != touched; ++k)
+                    sum += records[i].field[k];
+                return sum;
+            });
+    }
+    case record_layout::soa:
+    {
+        std::array<VALUETYPE*, Fields> const fields = r.fields;
+        return hpx::transform_reduce(hpx::execution::par, first, first + r.count,
+            0.0, std::plus<double>(), [=](std::size_t i) {
+                double sum = 0;
+                for (std::size_t k = 0; k != touched; ++k)
+                    sum += fields[k][i];
+                return sum;
+            });
+    }
+    case record_layout::aosoa:
+    default:
+    {
+        record_block<Fields> const* const blocks = r.blocks;
+        return hpx::transform_reduce(hpx::execution::par, first,
+            first + r.count / block_width, 0.0, std::plus<double>(),
+            [=](std::size_t b) {
+                double sum = 0;
+                for (std::size_t k = 0; k != touched; ++k)
+                    for (std::size_t l = 0; l != block_width; ++l)
+                        sum += blocks[b].field[k][l];
+                return sum;
+            });
+    }
+    }
+}
+
+// All-reduce of the local sums: in round s every locality forwards the sum
+// of locality this_locality - s to its right neighbour over the
+// channel_communicator, afterwards the sums are added up in the order of the
+// localities, so every locality gets bitwise the same result. Every call
+// gets its own range of channel tags.
+double all_reduce_localities(hpx::collectives::channel_communicator comm,
+    std::size_t num_localities, std::size_t this_locality, double local,
+    std::size_t generation)
+{
+    using hpx::collectives::get;
+    using hpx::collectives::set;
+    using hpx::collectives::tag_arg;
+    using hpx::collectives::that_site_arg;
+
+    std::size_t const right = (this_locality + 1) % num_localities;
+    std::size_t const left = (this_locality + num_localities - 1) % num_localities;
+    std::vector<double> values(num_localities);
+    values[this_locality] = local;
+    std::vector<hpx::future<void>> pending_sends;
+    for (std::size_t s = 0; s + 1 < num_localities; ++s)
+    {
+        std::size_t const send_index = (this_locality + num_localities - s) % num_localities;
+        std::size_t const receive_index = (send_index + num_localities - 1) % num_localities;
+        tag_arg const tag(generation * num_localities + s);
+        pending_sends.push_back(set(comm, that_site_arg(right),
+            double(values[send_index]), tag));
+        values[receive_index] = get<double>(comm, that_site_arg(left), tag).get();
+    }
+    for (auto& f : pending_sends)
+    {
+        f.get();
+    }
+    return std::accumulate(values.begin(), values.end(), 0.0);
+}
+
+// The kernel over size records of Fields fields in the given layout for every
+// number of touched fields
+template <std::size_t Fields>
+void run_layout(std::size_t size, record_layout layout, layout_kernel kernel,
+    std::vector<std::size_t> const& touched_fields, int loop_count, int warmup_loop_count)
+{
+    char const* const latch_name = "latch";
+    char const* const allreduce_channel_name = "layout_allreduce_channel";
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const this_locality = hpx::get_locality_id();
+
+    {
+        hpx::partitioned_vector<record<Fields>> aos;
+        std::vector<hpx::partitioned_vector<VALUETYPE>> soa;
+        hpx::partitioned_vector<record_block<Fields>> aosoa;
+        layout_records<Fields> r{layout, 0, nullptr, {}, nullptr};
+
+        switch (layout)
+        {
+        case record_layout::aos:
+        {
+            aos = create_vector<record<Fields>>(size, "aos_vector");
+            partitioned_vector_view<record<Fields>> view(aos);
+            r.count = view.size();
+            r.records = &*view.begin();
+            break;
+        }
+        case record_layout::soa:
+        {
+            for (std::size_t k = 0; k != Fields; ++k)
+            {
+                soa.push_back(create_vector<VALUETYPE>(
+                    size, "soa_vector_" + std::to_string(k)));
+                partitioned_vector_view<VALUETYPE> view(soa.back());
+                r.count = view.size();
+                r.fields[k] = &*view.begin();
+            }
+            break;
+        }
+        case record_layout::aosoa:
+        default:
+        {
+            aosoa = create_vector<record_block<Fields>>(
+                (size + block_width - 1) / block_width, "aosoa_vector");
+            partitioned_vector_view<record_block<Fields>> view(aosoa);
+            r.count = view.size() * block_width;
+            r.blocks = &*view.begin();
+            break;
+        }
+        }
+
+        hpx::distributed::latch latch;
+        if (0 == hpx::get_locality_id())
+        {
+            latch = hpx::distributed::latch(hpx::get_num_localities(hpx::launch::sync));
+            latch.register_as(latch_name);
+        }
+        else
+        {
+            latch.connect_to(latch_name);
+        }
+
+        hpx::collectives::channel_communicator allreduce_comm =
+            hpx::collectives::create_channel_communicator(hpx::launch::sync,
+                allreduce_channel_name,
+                hpx::collectives::num_sites_arg(num_localities),
+                hpx::collectives::this_site_arg(this_locality));
+
+        // records of all localities, aosoa includes the filled up records
+        std::size_t generation = 0;
+        std::size_t const total_count = static_cast<std::size_t>(all_reduce_localities(
+            allreduce_comm, num_localities, this_locality, double(r.count), generation++));
+
+        for (std::size_t touched : touched_fields)
+        {
+            // field k = k
+            hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), r.count,
+                [&](std::size_t i) {
+                    for (std::size_t k = 0; k != Fields; ++k)
+                        r.field(k, i) = VALUETYPE(k);
+                });
+
+            double sum = 0;
+            auto layout_round = [&]() {
+                if (kernel == layout_kernel::transform)
+                    layout_transform(r, touched);
+                else
+                    sum = all_reduce_localities(allreduce_comm, num_localities,
+                        this_locality, layout_reduce(r, touched), generation++);
+            };
+
+            // warm-up cache
+            for (int round = 1; round <= warmup_loop_count; ++round) {
+                layout_round();
+            }
+
+            //start timer
+            hpx::chrono::high_resolution_timer t;
+            for (int round = 1; round <= loop_count; ++round) {
+                layout_round();
+            }
+            //end timer
+            double elapsed = t.elapsed() / loop_count;
+
+            std::size_t const bytes = (kernel == layout_kernel::transform ? 2 : 1) *
+                touched * sizeof(VALUETYPE);
+            hpx::util::format_to(std::cout,
+                    "Touched Fields == {1}\n",
+                    touched);
+            hpx::util::format_to(std::cout,
+                    "Elapsed Time == {1} [s]\n",
+                    elapsed);
+            hpx::util::format_to(std::cout,
+                    "Bandwidth == {1} [GB/s]\n",
+                    bytes * total_count / elapsed / 1e9);
+            hpx::util::format_to(std::cout,
+                    "Record Rate == {1} [Grecords/s]\n",
+                    total_count / elapsed / 1e9);
+
+            // every locality checks its records, a touched field has been
+            // incremented once per round, the others are unchanged; the sum
+            // covers the records of all localities
+            std::size_t errors = 0;
+            if (kernel == layout_kernel::transform)
+            {
+                std::size_t const rounds = loop_count + warmup_loop_count;
+                for (std::size_t i = 0; i != r.count; ++i)
+                    for (std::size_t k = 0; k != Fields; ++k)
+                        errors += r.field(k, i) != VALUETYPE(k + (k < touched ? rounds : 0));
+            }
+            else
+            {
+                errors = sum != double(total_count) * (touched * (touched - 1) / 2);
+            }
+            hpx::util::format_to(std::cout,
+                    "Locality {1} Errors == {2}\n",
+                    hpx::get_locality_id(), errors);
+        }
+
+        // Wait for all localities to reach this point.
+        latch.arrive_and_wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int hpx_main(hpx::program_options::variables_map& vm)
+{
+    VALUETYPE size = vm["maxelems"].as<VALUETYPE>();
+    int loop_count = vm["loop_count"].as<int>();
+    int warmup_loop_count = vm["warmup_loop_count"].as<int>();
+    record_layout layout = parse_record_layout(vm["layout"].as<std::string>());
+    layout_kernel kernel = parse_layout_kernel(vm["layout_kernel"].as<std::string>());
+    std::size_t const fields = vm["fields"].as<std::size_t>();
+    std::size_t const touched = vm["touched_fields"].as<std::size_t>();
+    if (fields != 4 && fields != 8 && fields != 16)
+    {
+        throw std::invalid_argument("unsupported fields: " + std::to_string(fields));
+    }
+    if (touched > fields)
+    {
+        throw std::invalid_argument("touched_fields has to be at most fields");
+    }
+
+    // touched_fields 0 sweeps 1, 2, 4, ... fields
+    std::vector<std::size_t> touched_fields = {touched};
+    if (touched == 0)
+    {
+        touched_fields.clear();
+        for (std::size_t t = 1; t <= fields; t *= 2)
+            touched_fields.push_back(t);
+    }
+
+    //print vector size
+    if (0 == hpx::get_locality_id())
+    {
+        hpx::cout << "Layout Vector Size: " << size << "\n" << std::flush;
+        hpx::cout << "Layout: " << vm["layout"].as<std::string>() << "\n" << std::flush;
+        hpx::cout << "Layout Kernel: " << vm["layout_kernel"].as<std::string>() << "\n" << std::flush;
+        hpx::cout << "Fields: " << fields << "\n" << std::flush;
+    }
+
+    std::size_t const records = static_cast<std::size_t>(size);
+    if (fields == 4)
+        run_layout<4>(records, layout, kernel, touched_fields, loop_count, warmup_loop_count);
+    else if (fields == 8)
+        run_layout<8>(records, layout, kernel, touched_fields, loop_count, warmup_loop_count);
+    else
+        run_layout<16>(records, layout, kernel, touched_fields, loop_count, warmup_loop_count);
+
+    return hpx::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    // add command line option which controls the random number generator seed
+    using namespace hpx::program_options;
+    options_description desc_commandline(
+        "Usage: " HPX_APPLICATION_STRING " [options]");
+
+    desc_commandline.add_options()
+        ("maxelems,m",
+         value<VALUETYPE>()->default_value(1024)
+         ,"number of records")
+
+        ("loop_count"
+        , hpx::program_options::value<int>()->default_value(10)
+        , "number of rounds in performance measurement loop")
+
+        ("warmup_loop_count"
+        , hpx::program_options::value<int>()->default_value(4)
+        , "number of warmup rounds in cache warmup loop")
+
+        ("layout"
+        , hpx::program_options::value<std::string>()->default_value("aos")
+        , "record layout: aos (array of structs), soa (struct of arrays) or aosoa (blocks of struct of arrays)")
+
+        ("layout_kernel"
+        , hpx::program_options::value<std::string>()->default_value("transform")
+        , "kernel over the touched fields: transform (field + 1) or reduce (sum)")
+
+        ("fields"
+        , hpx::program_options::value<std::size_t>()->default_value(8)
+        , "fields per record: 4, 8 or 16")
+
+        ("touched_fields"
+        , hpx::program_options::value<std::size_t>()->default_value(0)
+        , "fields touched by the kernel, 0 sweeps 1, 2, 4, ... fields")
+        ;
+
+    // run hpx_main on all localities
+    std::vector<std::string> const cfg = {"hpx.run_hpx_main!=1"};
+
+    // Initialize and run HPX
+    hpx::init_params init_args;
+    init_args.desc_cmdline = desc_commandline;
+    init_args.cfg = cfg;
+
+    return hpx::init(argc, argv, init_args);
+}
+#endif
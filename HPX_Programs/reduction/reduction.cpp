@@ -3,24 +3,141 @@
 #include <hpx/algorithm.hpp>
 #include <hpx/hpx.hpp>
 #include <hpx/hpx_init.hpp>
+#include <hpx/include/compute.hpp>
 #include <hpx/include/partitioned_vector.hpp>
+#include <hpx/include/partitioned_vector_predef.hpp>
+#include <hpx/iterator_support/counting_iterator.hpp>
+#include <hpx/modules/collectives.hpp>
  
 #include <hpx/modules/program_options.hpp>
+#include <hpx/modules/resource_partitioner.hpp>
+#include <hpx/modules/topology.hpp>
  
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <random>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 #include <hpx/iostream.hpp>
 
+#include "compressed.hpp"
+#include "storage.hpp"
+#include "summation.hpp"
+
 ///////////////////////////////////////////////////////////////////////////////
 using VALUETYPE = float;
+using KEYTYPE = std::int64_t;
+
+// statistics computed by the fused reduction kernel
+struct statistics
+{
+    VALUETYPE sum;
+    VALUETYPE min;
+    VALUETYPE max;
+    VALUETYPE sum_of_squares;
+    std::uint64_t count;
+
+    static statistics identity()
+    {
+        return statistics{0, std::numeric_limits<VALUETYPE>::max(),
+            std::numeric_limits<VALUETYPE>::lowest(), 0, 0};
+    }
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int)
+    {
+        ar & sum & min & max & sum_of_squares & count;
+    }
+};
+
+// minimum and maximum with their global indices, computed by the minmaxloc
+// kernel
+struct extremum_location
+{
+    VALUETYPE min;
+    std::uint64_t min_index;
+    VALUETYPE max;
+    std::uint64_t max_index;
+
+    static extremum_location identity()
+    {
+        return extremum_location{std::numeric_limits<VALUETYPE>::max(),
+            std::numeric_limits<std::uint64_t>::max(),
+            std::numeric_limits<VALUETYPE>::lowest(),
+            std::numeric_limits<std::uint64_t>::max()};
+    }
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int)
+    {
+        ar & min & min_index & max & max_index;
+    }
+};
+
+// key and sum of a run of equal keys, see reduce-by-key
+struct run_carry
+{
+    KEYTYPE key;
+    VALUETYPE sum;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int)
+    {
+        ar & key & sum;
+    }
+};
+
+// reduced precision storage types, see reduced precision storage
+using numa::bfloat16;
+using numa::float16;
+using numa::int8_scaled;
+using numa::int16_scaled;
+using numa::storage_codec;
+
+// accumulators of the summation modes, see summation modes
+using compensated_sum = numa::compensated_sum<VALUETYPE>;
+using numa::binned_sum;
+using numa::summation_exact_sum;
+using numa::summation_value;
+
+// hash of the generated values, see include/compressed.hpp
+using numa::splitmix64;
 
-// Define the vector types to be used.
+// formats and words of the compressed storage, see compressed storage
+using numa::bitpacked_format;
+using numa::delta_for_format;
+using numa::uncompressed_format;
+using compressed_word = std::uint32_t;
+
+// Define the vector types to be used, partitioned_vector<double> is
+// predefined by HPX.
 HPX_REGISTER_PARTITIONED_VECTOR(VALUETYPE)
+HPX_REGISTER_PARTITIONED_VECTOR(KEYTYPE)
+HPX_REGISTER_PARTITIONED_VECTOR(statistics)
+HPX_REGISTER_PARTITIONED_VECTOR(extremum_location)
+HPX_REGISTER_PARTITIONED_VECTOR(compensated_sum)
+HPX_REGISTER_PARTITIONED_VECTOR(binned_sum)
+HPX_REGISTER_PARTITIONED_VECTOR(bfloat16)
+HPX_REGISTER_PARTITIONED_VECTOR(float16)
+HPX_REGISTER_PARTITIONED_VECTOR(int8_scaled)
+HPX_REGISTER_PARTITIONED_VECTOR(int16_scaled)
+HPX_REGISTER_PARTITIONED_VECTOR(compressed_word)
 
 hpx::init_params init_args;
 ///////////////////////////////////////////////////////////////////////////////
@@ -29,7 +146,8 @@ hpx::init_params init_args;
 // which is located on the current locality.
 //
 // This view does not own the data and relies on the partitioned_vector to be
-// available during the full lifetime of the view.
+// available during the full lifetime of the view. offset() is the global index
+// of the first element of the view.
 //
 template <typename T>
 struct partitioned_vector_view
@@ -53,6 +171,7 @@ public:
 public:
     explicit partitioned_vector_view(hpx::partitioned_vector<T>& data)
       : segment_iterator_(data.segment_begin(hpx::get_locality_id()))
+      , offset_(data.get_global_index(segment_iterator_, 0))
     {
     }
     iterator begin()
@@ -95,119 +214,2699 @@ public:
         return (*segment_iterator_).size();
     }
  
+    std::size_t offset() const
+    {
+        return offset_;
+    }
+ 
 private:
     local_segment_iterator segment_iterator_;
+    std::size_t offset_;
 };
  
 ///////////////////////////////////////////////////////////////////////////////
-int hpx_main(hpx::program_options::variables_map& vm)
+//
+// All-reduce of one value per locality.
+//
+// Every locality contributes the sum of its own part of the vector and gets
+// back the sum of all localities. The values are exchanged point-to-point
+// over a channel_communicator which is created once before the measurement,
+// so no global barrier and no remote partitioned_vector access is involved.
+// All algorithms combine the values in the same order on every locality, so
+// every locality gets bitwise the same result.
+//
+// Situation example (3 Localities, local sums 10 10 10):
+// L0 result 30
+// L1 result 30
+// L2 result 30
+//
+enum class allreduce_algorithm
 {
-    VALUETYPE size = vm["maxelems"].as<VALUETYPE>();
-    int loop_count = vm["loop_count"].as<int>();
-    int warmup_loop_count = vm["warmup_loop_count"].as<int>();
-    
-    //print vector size
-    if (0 == hpx::get_locality_id())
+    tree,                  // binomial reduce to L0 and broadcast, 2*log2(n) hops
+    recursive_doubling,    // pairwise exchange, log2(n) rounds (+2 if n is no power of 2)
+    ring                   // every value travels around the ring, n-1 rounds
+};
+
+allreduce_algorithm parse_allreduce_algorithm(std::string const& name)
+{
+    if (name == "tree")
+        return allreduce_algorithm::tree;
+    if (name == "recursive_doubling")
+        return allreduce_algorithm::recursive_doubling;
+    if (name == "ring")
+        return allreduce_algorithm::ring;
+    throw std::invalid_argument("unknown allreduce_algorithm: " + name);
+}
+
+// Every round gets its own range of channel tags, so messages of consecutive
+// rounds can never be mixed up: the tree uses [0, 128) (broadcast from 64
+// on), recursive doubling [0, 66) and the ring [128, 128 + n).
+constexpr std::size_t allreduce_broadcast_tag = 64;
+constexpr std::size_t allreduce_ring_tag = 128;
+
+inline hpx::collectives::tag_arg allreduce_tag(std::size_t generation,
+    std::size_t step, std::size_t num_localities)
+{
+    return hpx::collectives::tag_arg(
+        generation * (allreduce_ring_tag + num_localities) + step);
+}
+
+// The returned value is the sum of the values of all localities. Outgoing
+// messages are appended to pending_sends and have to be waited for by the
+// caller.
+template <typename T, typename Op>
+T all_reduce_localities(hpx::collectives::channel_communicator comm,
+    std::size_t num_localities, std::size_t this_locality, T const& local,
+    Op&& op, allreduce_algorithm algorithm, std::size_t generation,
+    std::vector<hpx::future<void>>& pending_sends)
+{
+    using hpx::collectives::get;
+    using hpx::collectives::set;
+    using hpx::collectives::that_site_arg;
+
+    auto tag = [&](std::size_t step) {
+        return allreduce_tag(generation, step, num_localities);
+    };
+
+    T result = local;
+
+    switch (algorithm)
     {
-        hpx::cout << "Reduction Vector Size: " << size << "\n" << std::flush;
+    case allreduce_algorithm::tree:
+    {
+        // reduce: the locality is the root of the subtree
+        // [this_locality, this_locality + 2^k) for every k below its level
+        std::size_t level = 0;
+        std::size_t d = 1;
+        for (; d < num_localities; d <<= 1, ++level)
+        {
+            if (this_locality % (2 * d) != 0)
+            {
+                // hand the sum of the own subtree to the parent
+                pending_sends.push_back(set(comm, that_site_arg(this_locality - d),
+                    T(result), tag(level)));
+                break;
+            }
+            if (this_locality + d < num_localities)
+            {
+                result = op(result, get<T>(comm, that_site_arg(this_locality + d),
+                    tag(level)).get());
+            }
+        }
+
+        // broadcast: receive the result from the parent and pass it on to
+        // every child (the largest subtree first)
+        if (this_locality != 0)
+        {
+            result = get<T>(comm, that_site_arg(this_locality - d),
+                tag(allreduce_broadcast_tag + level)).get();
+        }
+        for (std::size_t k = level; k-- != 0;)
+        {
+            std::size_t child = this_locality + (std::size_t(1) << k);
+            if (child < num_localities)
+            {
+                pending_sends.push_back(set(comm, that_site_arg(child),
+                    T(result), tag(allreduce_broadcast_tag + k)));
+            }
+        }
+        break;
     }
- 
-    char const* const vector_name_1 =
-        "v_vector";
-    char const* const vector_name_2 =
-        "sums_per_locality_vector";
- 
+
+    case allreduce_algorithm::recursive_doubling:
     {
-        // create vector on one locality, connect to it from all others
-        hpx::partitioned_vector<VALUETYPE> v;
-        hpx::partitioned_vector<VALUETYPE> sums_per_locality;
-        
-        if (0 == hpx::get_locality_id())
+        // the localities beyond the largest power of 2 hand their value to a
+        // partner and get the result back at the end
+        std::size_t p = 1;
+        while (2 * p <= num_localities)
         {
-            std::vector<hpx::id_type> localities = hpx::find_all_localities();
-            
-            v = hpx::partitioned_vector<VALUETYPE>(
-                                              size, hpx::container_layout(localities));
-            v.register_as(vector_name_1);
+            p <<= 1;
+        }
+        std::size_t const folded = num_localities - p;
 
-            sums_per_locality = hpx::partitioned_vector<VALUETYPE>(localities.size(), hpx::container_layout(localities));
-            sums_per_locality.register_as(vector_name_2);
+        if (this_locality >= p)
+        {
+            pending_sends.push_back(set(comm, that_site_arg(this_locality - p),
+                T(result), tag(0)));
+            result = get<T>(comm, that_site_arg(this_locality - p),
+                tag(allreduce_broadcast_tag + 1)).get();
+            break;
         }
-        else
+        if (this_locality < folded)
         {
-            hpx::future<void> f1 = v.connect_to(vector_name_1);
-            hpx::future<void> f2 = sums_per_locality.connect_to(vector_name_2);
-            f1.get();
-            f2.get();
+            result = op(result, get<T>(comm, that_site_arg(this_locality + p),
+                tag(0)).get());
         }
 
-        // fill vector v with numbers 2
-        partitioned_vector_view<VALUETYPE> view_v(v);
-        hpx::generate(hpx::execution::par, view_v.begin(), view_v.end(),
-                      [&]() { return 2; });
-        
-        partitioned_vector_view<VALUETYPE> view_sums_per_locality(sums_per_locality);
-        
-        for (int round = 1; round <= warmup_loop_count; ++round) {
-            VALUETYPE result = hpx::reduce(hpx::execution::par, view_v.begin() , view_v.end());
-            view_sums_per_locality[0] = result;
-            
-            // Wait for all localities to reach this point.
-            hpx::distributed::barrier::synchronize();
-            if (0 == hpx::get_locality_id())
-            {
-                VALUETYPE result = hpx::reduce(hpx::execution::par, sums_per_locality.begin() , sums_per_locality.end());
-            }
+        // after round k, result holds the sum of the group of 2^(k+1)
+        // localities this locality belongs to, the lower group comes first
+        std::size_t step = 1;
+        for (std::size_t d = 1; d < p; d <<= 1, ++step)
+        {
+            std::size_t const partner = this_locality ^ d;
+            pending_sends.push_back(set(comm, that_site_arg(partner),
+                T(result), tag(step)));
+            T received = get<T>(comm, that_site_arg(partner), tag(step)).get();
+            result = partner < this_locality ? op(received, result) : op(result, received);
         }
-        
-        //start timer
-        hpx::chrono::high_resolution_timer t;
-        
-        for (int round = 1; round <= loop_count; ++round) {
-            VALUETYPE result = hpx::reduce(hpx::execution::par, view_v.begin() , view_v.end());
-            view_sums_per_locality[0] = result;
 
-            //hpx::cout << "locality: " << hpx::get_locality_id() <<  ", Reduction: " << result << "\n" << std::flush;
-            
-            // Wait for all localities to reach this point.
-            hpx::distributed::barrier::synchronize();
+        if (this_locality < folded)
+        {
+            pending_sends.push_back(set(comm, that_site_arg(this_locality + p),
+                T(result), tag(allreduce_broadcast_tag + 1)));
+        }
+        break;
+    }
 
-            if (0 == hpx::get_locality_id())
-            {
-                VALUETYPE result = hpx::reduce(hpx::execution::par, sums_per_locality.begin() , sums_per_locality.end());
-                //hpx::cout << "result: " << result << "\n" << std::flush;
-            }
+    case allreduce_algorithm::ring:
+    {
+        // in round s every locality forwards the value of locality
+        // this_locality - s to its right neighbour, afterwards all values are
+        // summed up in the order of the localities
+        std::size_t const right = (this_locality + 1) % num_localities;
+        std::size_t const left = (this_locality + num_localities - 1) % num_localities;
+        std::vector<T> values(num_localities);
+        values[this_locality] = local;
+        for (std::size_t s = 0; s + 1 < num_localities; ++s)
+        {
+            std::size_t const send_index = (this_locality + num_localities - s) % num_localities;
+            std::size_t const receive_index = (send_index + num_localities - 1) % num_localities;
+            pending_sends.push_back(set(comm, that_site_arg(right),
+                T(values[send_index]), tag(allreduce_ring_tag + s)));
+            values[receive_index] = get<T>(comm, that_site_arg(left),
+                tag(allreduce_ring_tag + s)).get();
         }
-        
-        //end timer
-        double elapsed = t.elapsed() / loop_count;
-        hpx::util::format_to(std::cout,
-                "Elapsed Time == {1} [s]\n",
-                elapsed);
+        result = values[0];
+        for (std::size_t i = 1; i < num_localities; ++i)
+        {
+            result = op(result, values[i]);
+        }
+        break;
     }
-         
-    return hpx::finalize();
+    }
+
+    return result;
 }
+///////////////////////////////////////////////////////////////////////////////
+//
+// Fused statistics kernel.
+//
+// Sum, minimum, maximum, sum of squares and count of the local part of the
+// vector in a single pass, instead of one hpx::reduce per statistic.
+//
+enum class reduction_kernel
+{
+    sum,           // hpx::reduce of the sum only
+    statistics,    // fused kernel
+    rows,          // sums of short rows, see row reductions
+    minmaxloc,     // minimum and maximum with their global indices
+    by_key,        // sums of runs of equal keys, see reduce-by-key
+    histogram      // counts per bin, see histogram
+};
 
-int main(int argc, char* argv[])
+reduction_kernel parse_reduction_kernel(std::string const& name)
 {
-    // add command line option which controls the random number generator seed
-    using namespace hpx::program_options;
-    options_description desc_commandline(
-        "Usage: " HPX_APPLICATION_STRING " [options]");
+    if (name == "sum")
+        return reduction_kernel::sum;
+    if (name == "statistics")
+        return reduction_kernel::statistics;
+    if (name == "rows")
+        return reduction_kernel::rows;
+    if (name == "minmaxloc")
+        return reduction_kernel::minmaxloc;
+    if (name == "by_key")
+        return reduction_kernel::by_key;
+    if (name == "histogram")
+        return reduction_kernel::histogram;
+    throw std::invalid_argument("unknown reduction_kernel: " + name);
+}
 
-    desc_commandline.add_options()
-        ("maxelems,m",
-         value<VALUETYPE>()->default_value(1024)
-         ,"size of the vector")
-    
-        ("loop_count"
-        , hpx::program_options::value<int>()->default_value(10)
-        , "number of rounds in performance measurement loop")
-    
-        ("warmup_loop_count"
-        , hpx::program_options::value<int>()->default_value(4)
-        , "number of warmup rounds in cache warmup loop")
+// combines the statistics of two ranges, used across threads and localities
+struct statistics_combine
+{
+    statistics operator()(statistics const& a, statistics const& b) const
+    {
+        return statistics{a.sum + b.sum, (std::min)(a.min, b.min),
+            (std::max)(a.max, b.max), a.sum_of_squares + b.sum_of_squares,
+            a.count + b.count};
+    }
+
+    template <typename Archive>
+    void serialize(Archive&, unsigned int)
+    {
+    }
+};
+
+// Statistics of [first, last) on a single thread. The elements are spread
+// over independent accumulators (lanes), so the compiler can vectorize the
+// loop without reassociating the floating point sums.
+template <typename Iter>
+statistics block_statistics(Iter first, Iter last)
+{
+    constexpr std::size_t lanes = 16;
+    std::size_t const count = std::distance(first, last);
+
+    VALUETYPE sum[lanes];
+    VALUETYPE min[lanes];
+    VALUETYPE max[lanes];
+    VALUETYPE sum_of_squares[lanes];
+    for (std::size_t l = 0; l != lanes; ++l)
+    {
+        sum[l] = 0;
+        min[l] = std::numeric_limits<VALUETYPE>::max();
+        max[l] = std::numeric_limits<VALUETYPE>::lowest();
+        sum_of_squares[l] = 0;
+    }
+
+    std::size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        for (std::size_t l = 0; l != lanes; ++l)
+        {
+            VALUETYPE const x = first[i + l];
+            sum[l] += x;
+            sum_of_squares[l] += x * x;
+            min[l] = x < min[l] ? x : min[l];
+            max[l] = x > max[l] ? x : max[l];
+        }
+    }
+
+    statistics result = statistics::identity();
+    for (std::size_t l = 0; l != lanes; ++l)
+    {
+        result = statistics_combine()(result,
+            statistics{sum[l], min[l], max[l], sum_of_squares[l], 0});
+    }
+    for (; i != count; ++i)
+    {
+        VALUETYPE const x = first[i];
+        result = statistics_combine()(result, statistics{x, x, x, x * x, 0});
+    }
+    result.count = count;
+    return result;
+}
+
+// Reduction of [first, last) split into 4 blocks per worker thread, the
+// blocks are executed with policy on num_workers threads. block reduces a
+// single block on one thread, the block results are combined in order with op.
+template <typename ExPolicy, typename Iter, typename T, typename Block, typename Op>
+T reduce_blocks(ExPolicy&& policy, std::size_t num_workers, Iter first, Iter last,
+    T const& identity, Block&& block, Op&& op)
+{
+    std::size_t const count = std::distance(first, last);
+    std::size_t const num_blocks = (std::max)(std::size_t(1),
+        (std::min)(count, 4 * num_workers));
+    std::size_t const block_size = (count + num_blocks - 1) / num_blocks;
+
+    std::vector<T> partials(num_blocks, identity);
+    hpx::experimental::for_loop(policy, std::size_t(0), num_blocks,
+        [&](std::size_t k) {
+            std::size_t const begin = (std::min)(k * block_size, count);
+            std::size_t const end = (std::min)(begin + block_size, count);
+            partials[k] = block(first + begin, first + end);
+        });
+    return std::accumulate(partials.begin(), partials.end(), identity, op);
+}
+///////////////////////////////////////////////////////////////////////////////
+//
+// Min-loc / max-loc kernel.
+//
+// Minimum and maximum of the vector together with their global indices. The
+// local index of an element is translated with the offset of the partition of
+// its locality. Of equal extrema the one with the lowest index wins, so the
+// result is the first occurrence independent of the partitioning. Both
+// extrema are carried in one extremum_location, so the localities are
+// combined with a single reduction.
+//
+// Situation example (2 Localities):
+// L0 values 2 1 2 2   offset 0
+// L1 values 2 2 3 1   offset 4
+// result    min 1 at 1, max 3 at 6
+//
+
+// combines the extrema of two ranges, used across threads and localities
+struct extremum_combine
+{
+    extremum_location operator()(extremum_location const& a, extremum_location const& b) const
+    {
+        extremum_location result = a;
+        if (b.min < a.min || (b.min == a.min && b.min_index < a.min_index))
+        {
+            result.min = b.min;
+            result.min_index = b.min_index;
+        }
+        if (b.max > a.max || (b.max == a.max && b.max_index < a.max_index))
+        {
+            result.max = b.max;
+            result.max_index = b.max_index;
+        }
+        return result;
+    }
+
+    template <typename Archive>
+    void serialize(Archive&, unsigned int)
+    {
+    }
+};
+
+// Extrema of [first, last) on a single thread, first_index is the global
+// index of first. Every lane keeps the first occurrence of its extrema, the
+// branch free selects let the compiler vectorize the loop.
+template <typename Iter>
+extremum_location block_extrema(Iter first, Iter last, std::uint64_t first_index)
+{
+    constexpr std::size_t lanes = 16;
+    std::size_t const count = std::distance(first, last);
+
+    VALUETYPE min[lanes];
+    std::uint64_t min_index[lanes];
+    VALUETYPE max[lanes];
+    std::uint64_t max_index[lanes];
+    for (std::size_t l = 0; l != lanes; ++l)
+    {
+        min[l] = std::numeric_limits<VALUETYPE>::max();
+        min_index[l] = 0;
+        max[l] = std::numeric_limits<VALUETYPE>::lowest();
+        max_index[l] = 0;
+    }
+
+    std::size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        for (std::size_t l = 0; l != lanes; ++l)
+        {
+            VALUETYPE const x = first[i + l];
+            bool const less = x < min[l];
+            bool const greater = x > max[l];
+            min_index[l] = less ? i + l : min_index[l];
+            min[l] = less ? x : min[l];
+            max_index[l] = greater ? i + l : max_index[l];
+            max[l] = greater ? x : max[l];
+        }
+    }
+
+    extremum_location result = extremum_location::identity();
+    if (i != 0)
+    {
+        for (std::size_t l = 0; l != lanes; ++l)
+        {
+            result = extremum_combine()(result, extremum_location{min[l],
+                first_index + min_index[l], max[l], first_index + max_index[l]});
+        }
+    }
+    for (; i != count; ++i)
+    {
+        VALUETYPE const x = first[i];
+        result = extremum_combine()(result,
+            extremum_location{x, first_index + i, x, first_index + i});
+    }
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Summation modes of the sum kernel.
+//
+// plain:        hpx::reduce, the rounding depends on how the algorithm chunks
+//               the range, i.e. on the thread count, and on the locality count
+// compensated:  Kahan-Babuska-Neumaier summation, the rounding errors are
+//               carried along to the final result
+// pairwise:     pairwise summation of every block, the rounding error grows
+//               with log(n) instead of n
+// reproducible: binned_sum, exact until the final rounding, so the result is
+//               bitwise the same for every thread count and locality count
+//
+// Every mode except plain provides the reducer of the blocks (see
+// reduce_blocks) and of the locality results and the final value.
+//
+// The modes other than plain sum summation_value (include/summation.hpp)
+// instead of 2s, mixed magnitudes and signs with a known exact sum, so the
+// relative error tells the modes apart.
+//
+enum class summation_mode
+{
+    plain,
+    compensated,
+    pairwise,
+    reproducible
+};
+
+summation_mode parse_summation_mode(std::string const& name)
+{
+    if (name == "plain")
+        return summation_mode::plain;
+    if (name == "compensated")
+        return summation_mode::compensated;
+    if (name == "pairwise")
+        return summation_mode::pairwise;
+    if (name == "reproducible")
+        return summation_mode::reproducible;
+    throw std::invalid_argument("unknown summation: " + name);
+}
+
+// The reducers adapt the accumulators of include/summation.hpp to
+// reduce_blocks and combine_localities.
+struct compensated_reducer
+{
+    using value_type = compensated_sum;
+
+    static compensated_sum identity()
+    {
+        return compensated_sum{};
+    }
+
+    template <typename Iter>
+    static compensated_sum block(Iter first, Iter last)
+    {
+        compensated_sum result = identity();
+        result.add_range(first, last);
+        return result;
+    }
+
+    compensated_sum operator()(compensated_sum a, compensated_sum const& b) const
+    {
+        a.merge(b);
+        return a;
+    }
+
+    static VALUETYPE value(compensated_sum const& a)
+    {
+        return a.value();
+    }
+
+    template <typename Archive>
+    void serialize(Archive&, unsigned int)
+    {
+    }
+};
+
+struct pairwise_reducer
+{
+    using value_type = VALUETYPE;
+
+    static VALUETYPE identity()
+    {
+        return 0;
+    }
+
+    template <typename Iter>
+    static VALUETYPE block(Iter first, Iter last)
+    {
+        return numa::pairwise_sum<VALUETYPE>::pairwise(first, last);
+    }
+
+    VALUETYPE operator()(VALUETYPE a, VALUETYPE b) const
+    {
+        return a + b;
+    }
+
+    static VALUETYPE value(VALUETYPE a)
+    {
+        return a;
+    }
+
+    template <typename Archive>
+    void serialize(Archive&, unsigned int)
+    {
+    }
+};
+
+struct reproducible_reducer
+{
+    using value_type = binned_sum;
+
+    static binned_sum identity()
+    {
+        return binned_sum{};
+    }
+
+    template <typename Iter>
+    static binned_sum block(Iter first, Iter last)
+    {
+        binned_sum result = identity();
+        result.add_range(first, last);
+        return result;
+    }
+
+    binned_sum operator()(binned_sum a, binned_sum const& b) const
+    {
+        a.merge(b);
+        return a;
+    }
+
+    // rounded to nearest even exactly once, see include/summation.hpp
+    static VALUETYPE value(binned_sum const& a)
+    {
+        return a.value();
+    }
+
+    template <typename Archive>
+    void serialize(Archive&, unsigned int)
+    {
+    }
+};
+///////////////////////////////////////////////////////////////////////////////
+//
+// Reduction modes.
+//
+// barrier:   every locality writes its sum into its element of the
+//            partitioned_vector sums_per_locality, after a global barrier
+//            locality 0 reduces the remote vector, the other localities never
+//            see the result.
+// allreduce: the sums are combined with all_reduce_localities, every
+//            locality gets the result.
+// async:     the local part of the vector is split into in_flight slices,
+//            the reductions of all slices are in flight at the same time.
+//            Every slice is reduced with a task policy and combined with
+//            all_reduce_localities in the continuation of its local sum, so
+//            no global barrier is involved. The latency of a reduction runs
+//            from its launch until its global result is available.
+//
+enum class reduction_mode
+{
+    barrier,
+    allreduce,
+    async
+};
+
+reduction_mode parse_reduction_mode(std::string const& name)
+{
+    if (name == "barrier")
+        return reduction_mode::barrier;
+    if (name == "allreduce")
+        return reduction_mode::allreduce;
+    if (name == "async")
+        return reduction_mode::async;
+    throw std::invalid_argument("unknown reduction_mode: " + name);
+}
+
+// p-th percentile (nearest rank) of the sorted values
+double percentile(std::vector<double> const& sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    std::size_t const rank = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+    return sorted[(std::max)(rank, std::size_t(1)) - 1];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Local reductions.
+//
+// flat: one reduction over all worker threads of the locality.
+// numa: the local part of the vector is split into one slice per NUMA
+//       domain, in proportion to the cores of the domain. Every slice is
+//       reduced on the cores of its own domain, the domain results are
+//       combined in domain order inside the locality and then across the
+//       localities (NUMA domain -> node -> cluster).
+//
+// The partition of the vector is allocated and zeroed on a single thread
+// when it is created, so its pages sit on the domain of that thread. The
+// numa reduction therefore works on a copy of the local part (numa_slices):
+// the slice of every domain is allocated and copied by a task on the
+// executor of the domain, which first-touches its pages there. The copy is
+// made once before the measurement and doubles the memory of the local part.
+//
+enum class local_reduction
+{
+    flat,
+    numa
+};
+
+local_reduction parse_local_reduction(std::string const& name)
+{
+    if (name == "flat")
+        return local_reduction::flat;
+    if (name == "numa")
+        return local_reduction::numa;
+    throw std::invalid_argument("unknown local_reduction: " + name);
+}
+
+// The NUMA domains of this locality which contain at least one worker
+// thread, with an executor on the cores of every domain. cores[d] is the
+// number of worker threads bound to a PU of domain d.
+struct numa_hierarchy
+{
+    using executor_type = hpx::compute::host::block_executor<>;
+
+    std::vector<executor_type> executors;
+    std::vector<std::size_t> cores;
+
+    numa_hierarchy()
+    {
+        auto& partitioner = hpx::resource::get_partitioner();
+        std::size_t const num_threads = hpx::get_os_thread_count();
+        for (auto const& domain : hpx::compute::host::numa_domains())
+        {
+            hpx::threads::mask_cref_type pus = domain.native_handle().get_device();
+            std::size_t used = 0;
+            for (std::size_t t = 0; t != num_threads; ++t)
+            {
+                if (hpx::threads::test(pus, partitioner.get_pu_num(t)))
+                {
+                    ++used;
+                }
+            }
+            if (used != 0)
+            {
+                executors.emplace_back(std::vector<hpx::compute::host::target>{domain});
+                cores.push_back(used);
+            }
+        }
+        if (executors.empty())
+        {
+            throw std::runtime_error("no NUMA domain with worker threads found");
+        }
+    }
+
+    std::size_t size() const
+    {
+        return executors.size();
+    }
+
+    // [first, second) of the slice of domain d among count elements
+    std::pair<std::size_t, std::size_t> slice(std::size_t d, std::size_t count) const
+    {
+        std::size_t const total = std::accumulate(cores.begin(), cores.end(), std::size_t(0));
+        std::size_t const before = std::accumulate(cores.begin(), cores.begin() + d, std::size_t(0));
+        return std::make_pair(count * before / total, count * (before + cores[d]) / total);
+    }
+};
+
+// Copy of the local part of a vector, split into the slices of hierarchy.
+// The slice of every domain is allocated (and so first-touched) and copied by
+// a task on the executor of its domain. offsets[d] is the local index of the
+// first element of slice d.
+template <typename T>
+struct numa_slices
+{
+    std::vector<std::vector<T>> slices;
+    std::vector<std::size_t> offsets;
+
+    numa_slices(numa_hierarchy& hierarchy, partitioned_vector_view<T>& view)
+      : slices(hierarchy.size())
+      , offsets(hierarchy.size())
+    {
+        typename partitioned_vector_view<T>::iterator const first = view.begin();
+        std::vector<hpx::future<void>> placed;
+        placed.reserve(hierarchy.size());
+        for (std::size_t d = 0; d != hierarchy.size(); ++d)
+        {
+            std::pair<std::size_t, std::size_t> const slice = hierarchy.slice(d, view.size());
+            offsets[d] = slice.first;
+            placed.push_back(hpx::async(hierarchy.executors[d], [&, d, slice]() {
+                slices[d].resize(slice.second - slice.first);
+                hpx::copy(hpx::execution::par.on(hierarchy.executors[d]),
+                    first + slice.first, first + slice.second, slices[d].begin());
+            }));
+        }
+        hpx::wait_all(placed);
+    }
+};
+
+// Time per level of the reduction, summed up over the measured rounds
+struct level_timings
+{
+    // time until the slice of every NUMA domain is reduced (numa only)
+    std::vector<double> domains;
+    // time until all domains are reduced, i.e. the slowest domain (numa only)
+    double domain_level = 0;
+    // flat: the whole local reduction, numa: combination of the domain results
+    double node_level = 0;
+    // combination of the locality results, including the wait for the
+    // slowest locality
+    double cluster_level = 0;
+
+    explicit level_timings(std::size_t num_domains)
+      : domains(num_domains, 0)
+    {
+    }
+};
+
+// Reduction of the slices of data over the NUMA domains of hierarchy.
+// reduce_range(policy, num_workers, first, last, index) reduces the slice of a
+// domain with an execution policy on the cores of the domain, index is the
+// local index of first. The domain results are combined in domain order with op.
+template <typename V, typename T, typename ReduceRange, typename Op>
+T reduce_numa_domains(numa_hierarchy& hierarchy, numa_slices<V>& data,
+    T const& identity, ReduceRange&& reduce_range, Op&& op, level_timings& timings)
+{
+    std::size_t const num_domains = hierarchy.size();
+
+    hpx::chrono::high_resolution_timer t_domain;
+    std::vector<hpx::future<T>> partials;
+    partials.reserve(num_domains);
+    for (std::size_t d = 0; d != num_domains; ++d)
+    {
+        partials.push_back(hpx::async(hierarchy.executors[d], [&, d]() {
+            T result = reduce_range(hpx::execution::par.on(hierarchy.executors[d]),
+                hierarchy.cores[d], data.slices[d].begin(), data.slices[d].end(),
+                data.offsets[d]);
+            timings.domains[d] += t_domain.elapsed();
+            return result;
+        }));
+    }
+    hpx::wait_all(partials);
+    timings.domain_level += t_domain.elapsed();
+
+    hpx::chrono::high_resolution_timer t_node;
+    T result = identity;
+    for (auto& f : partials)
+    {
+        result = op(result, f.get());
+    }
+    timings.node_level += t_node.elapsed();
+    return result;
+}
+ 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Row reductions.
+//
+// The local part of the vector is a sequence of short rows of row_length
+// elements, the sum of every row is stored in the partitioned_vector row_sums
+// (a segmented reduction), in the partition of the locality which holds the
+// row. Rows never span two localities, elements behind the last full row of a
+// locality are ignored.
+//
+// batched: a single parallel pass over all rows, every row is summed up on
+//          one thread.
+// per row: one hpx::reduce per row. Every call pays the fork/join of the
+//          parallel algorithm, so it is only measured on the first
+//          per_row_max_rows rows.
+//
+// Situation example (row_length 4, every element 2):
+// rows      2 2 2 2 | 2 2 2 2 | 2 2 2 2
+// row_sums  8         8         8
+//
+constexpr std::size_t per_row_max_rows = 1 << 16;
+
+// Sum of [first, last) on a single thread, spread over independent lanes like
+// block_statistics.
+template <typename Iter>
+VALUETYPE row_sum(Iter first, Iter last)
+{
+    constexpr std::size_t lanes = 16;
+    std::size_t const count = std::distance(first, last);
+
+    VALUETYPE sum[lanes] = {};
+    std::size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        for (std::size_t l = 0; l != lanes; ++l)
+        {
+            sum[l] += first[i + l];
+        }
+    }
+
+    VALUETYPE result = 0;
+    for (std::size_t l = 0; l != lanes; ++l)
+    {
+        result += sum[l];
+    }
+    for (; i != count; ++i)
+    {
+        result += first[i];
+    }
+    return result;
+}
+
+// Sums of the first num_rows rows starting at first in one parallel pass,
+// written to row_sums
+template <typename Iter, typename Out>
+void reduce_rows_batched(Iter first, std::size_t row_length, std::size_t num_rows, Out row_sums)
+{
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_rows,
+        [&](std::size_t r) {
+            Iter const row = first + r * row_length;
+            row_sums[r] = row_sum(row, row + row_length);
+        });
+}
+
+// Sums of the first num_rows rows starting at first, one hpx::reduce per row,
+// written to row_sums
+template <typename Iter, typename Out>
+void reduce_rows_per_row(Iter first, std::size_t row_length, std::size_t num_rows, Out row_sums)
+{
+    for (std::size_t r = 0; r != num_rows; ++r)
+    {
+        Iter const row = first + r * row_length;
+        row_sums[r] = hpx::reduce(hpx::execution::par, row, row + row_length,
+            VALUETYPE(0), std::plus<VALUETYPE>());
+    }
+}
+
+// Rows per second of both variants for every row length, measured on the
+// local part of a vector of size elements 2. Locality 0 prints the rates and
+// the crossover, i.e. the shortest row length for which one hpx::reduce per
+// row is at least as fast as the batched pass.
+void run_row_benchmark(std::size_t size, std::vector<std::size_t> const& row_lengths,
+    int loop_count, int warmup_loop_count)
+{
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+
+    char const* const vector_name = "rows_vector";
+    char const* const row_sums_name = "rows_row_sums_vector";
+
+    // every locality holds at most part_size elements of v and so at most
+    // part_size / shortest row length rows. row_sums has this many elements
+    // per locality.
+    std::size_t const part_size = (size + num_localities - 1) / num_localities;
+    std::size_t const max_rows =
+        part_size / *std::min_element(row_lengths.begin(), row_lengths.end());
+
+    hpx::partitioned_vector<VALUETYPE> v;
+    hpx::partitioned_vector<VALUETYPE> row_sums;
+    if (0 == hpx::get_locality_id())
+    {
+        std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+        v = hpx::partitioned_vector<VALUETYPE>(size, hpx::container_layout(localities));
+        v.register_as(vector_name);
+
+        row_sums = hpx::partitioned_vector<VALUETYPE>(
+            max_rows * localities.size(), hpx::container_layout(localities));
+        row_sums.register_as(row_sums_name);
+    }
+    else
+    {
+        hpx::future<void> f1 = v.connect_to(vector_name);
+        hpx::future<void> f2 = row_sums.connect_to(row_sums_name);
+        f1.get();
+        f2.get();
+    }
+
+    partitioned_vector_view<VALUETYPE> view(v);
+    partitioned_vector_view<VALUETYPE> view_row_sums(row_sums);
+    hpx::fill(hpx::execution::par, view.begin(), view.end(), VALUETYPE(2));
+
+    std::size_t crossover = 0;
+    for (std::size_t row_length : row_lengths)
+    {
+        std::size_t const num_rows = view.size() / row_length;
+        if (num_rows == 0)
+        {
+            continue;
+        }
+
+        // measures the rows per second of a variant on num_measured rows
+        auto rows_per_second = [&](auto reduce_rows, std::size_t num_measured) {
+            hpx::fill(hpx::execution::par, view_row_sums.begin(), view_row_sums.end(), VALUETYPE(0));
+            for (int round = 1; round <= warmup_loop_count; ++round)
+            {
+                reduce_rows(view.begin(), row_length, num_measured, view_row_sums.begin());
+            }
+            hpx::chrono::high_resolution_timer t;
+            for (int round = 1; round <= loop_count; ++round)
+            {
+                reduce_rows(view.begin(), row_length, num_measured, view_row_sums.begin());
+            }
+            double const elapsed = t.elapsed() / loop_count;
+            if (std::count(view_row_sums.begin(), view_row_sums.begin() + num_measured,
+                    VALUETYPE(2 * row_length)) != static_cast<std::ptrdiff_t>(num_measured))
+            {
+                throw std::runtime_error("wrong row sum");
+            }
+            return num_measured / elapsed;
+        };
+
+        using iterator = partitioned_vector_view<VALUETYPE>::iterator;
+        double const batched = rows_per_second(
+            [](iterator first, std::size_t length, std::size_t count, iterator sums) {
+                reduce_rows_batched(first, length, count, sums);
+            },
+            num_rows);
+        double const per_row = rows_per_second(
+            [](iterator first, std::size_t length, std::size_t count, iterator sums) {
+                reduce_rows_per_row(first, length, count, sums);
+            },
+            (std::min)(num_rows, per_row_max_rows));
+
+        if (crossover == 0 && per_row >= batched)
+        {
+            crossover = row_length;
+        }
+        if (0 == hpx::get_locality_id())
+        {
+            hpx::util::format_to(std::cout,
+                    "Row Length == {1} [elements], Rows == {2}, Batched == {3} [rows/s], "
+                    "Per Row == {4} [rows/s]\n",
+                    row_length, num_rows, batched, per_row);
+        }
+    }
+
+    if (0 == hpx::get_locality_id())
+    {
+        if (crossover != 0)
+        {
+            hpx::util::format_to(std::cout,
+                    "Crossover Row Length == {1} [elements]\n", crossover);
+        }
+        else
+        {
+            std::cout << "Crossover Row Length == none" << std::endl;
+        }
+    }
+}
+ 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Reduced precision storage.
+//
+// The vector is stored as bfloat16, float16 (IEEE half precision), or as 8 or
+// 16 bit integers with a scale (value = integer * scale). The sum kernel loads
+// the stored elements, converts them to float in software and accumulates in
+// float or double. Halving the bytes per element should nearly double the
+// elements per second of this memory bound kernel, so both rates are reported.
+//
+// The storage types and their codecs are shared with numa_v1, see
+// include/storage.hpp.
+//
+
+// Sum of [first, last) on a single thread, decoded with codec and accumulated
+// in Acc over independent lanes like row_sum.
+template <typename Acc, typename Iter, typename Codec>
+Acc decoded_sum(Iter first, Iter last, Codec const& codec)
+{
+    constexpr std::size_t lanes = 16;
+    std::size_t const count = std::distance(first, last);
+
+    Acc sum[lanes] = {};
+    std::size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        for (std::size_t l = 0; l != lanes; ++l)
+        {
+            sum[l] += codec.decode(first[i + l]);
+        }
+    }
+
+    Acc result = 0;
+    for (std::size_t l = 0; l != lanes; ++l)
+    {
+        result += sum[l];
+    }
+    for (; i != count; ++i)
+    {
+        result += codec.decode(first[i]);
+    }
+    return result;
+}
+
+// Sum kernel over a vector of size elements of type Storage, accumulated in
+// Acc. The localities are combined like the plain sum (barrier or
+// allreduce), all localities print their times.
+template <typename Storage, typename Acc>
+void run_storage_reduction(std::size_t size, int loop_count, int warmup_loop_count,
+    reduction_mode mode, allreduce_algorithm algorithm)
+{
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const this_locality = hpx::get_locality_id();
+
+    char const* const vector_name = "storage_vector";
+    char const* const sums_name = "storage_sums_per_locality_vector";
+    char const* const allreduce_channel_name = "storage_allreduce_channel";
+
+    hpx::partitioned_vector<Storage> v;
+    hpx::partitioned_vector<double> sums_per_locality;
+    if (0 == this_locality)
+    {
+        std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+        v = hpx::partitioned_vector<Storage>(size, hpx::container_layout(localities));
+        v.register_as(vector_name);
+
+        sums_per_locality = hpx::partitioned_vector<double>(localities.size(), hpx::container_layout(localities));
+        sums_per_locality.register_as(sums_name);
+    }
+    else
+    {
+        hpx::future<void> f1 = v.connect_to(vector_name);
+        hpx::future<void> f2 = sums_per_locality.connect_to(sums_name);
+        f1.get();
+        f2.get();
+    }
+
+    // element of this locality in sums_per_locality, built once outside of
+    // the measurement
+    partitioned_vector_view<double> view_sums(sums_per_locality);
+
+    // fill vector v with numbers 2
+    storage_codec<Storage> const codec(2);
+    partitioned_vector_view<Storage> view_v(v);
+    Storage const two = codec.encode(2);
+    hpx::generate(hpx::execution::par, view_v.begin(), view_v.end(),
+                  [&]() { return two; });
+
+    hpx::collectives::channel_communicator allreduce_comm;
+    if (mode != reduction_mode::barrier)
+    {
+        allreduce_comm = hpx::collectives::create_channel_communicator(hpx::launch::sync,
+            allreduce_channel_name,
+            hpx::collectives::num_sites_arg(num_localities),
+            hpx::collectives::this_site_arg(this_locality));
+    }
+
+    // returns the sum (valid on locality 0 in barrier mode)
+    auto reduction_round = [&](std::size_t generation) -> double {
+        using iterator = typename partitioned_vector_view<Storage>::iterator;
+        Acc result = reduce_blocks(hpx::execution::par, hpx::get_num_worker_threads(),
+            view_v.begin(), view_v.end(), Acc(0),
+            [&](iterator first, iterator last) { return decoded_sum<Acc>(first, last, codec); },
+            std::plus<Acc>());
+
+        if (mode != reduction_mode::barrier)
+        {
+            std::vector<hpx::future<void>> pending_sends;
+            result = all_reduce_localities(allreduce_comm, num_localities, this_locality,
+                result, std::plus<Acc>(), algorithm, generation, pending_sends);
+            for (auto& f : pending_sends)
+            {
+                f.get();
+            }
+            return result;
+        }
+
+        view_sums[0] = result;
+        hpx::distributed::barrier::synchronize();
+        if (0 == this_locality)
+        {
+            return hpx::reduce(hpx::execution::par, sums_per_locality.begin(),
+                sums_per_locality.end(), 0.0);
+        }
+        return result;
+    };
+
+    std::size_t generation = 0;
+    for (int round = 1; round <= warmup_loop_count; ++round) {
+        reduction_round(++generation);
+    }
+
+    //start timer
+    hpx::chrono::high_resolution_timer t;
+
+    double result = 0;
+    for (int round = 1; round <= loop_count; ++round) {
+        result = reduction_round(++generation);
+    }
+
+    //end timer
+    double elapsed = t.elapsed() / loop_count;
+    hpx::util::format_to(std::cout,
+            "Elapsed Time == {1} [s]\n",
+            elapsed);
+    hpx::util::format_to(std::cout,
+            "Bandwidth == {1} [GB/s]\n",
+            size * sizeof(Storage) / elapsed / 1e9);
+    hpx::util::format_to(std::cout,
+            "Element Rate == {1} [Gelements/s]\n",
+            size / elapsed / 1e9);
+
+    if (0 == this_locality)
+    {
+        std::cout << "Reduction Result == " << std::setprecision(9) << result << std::endl;
+        hpx::util::format_to(std::cout,
+                "Relative Error == {1}\n",
+                std::abs(result - 2.0 * size) / (2.0 * size));
+    }
+}
+ 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Reduce-by-key.
+//
+// keys is a sorted partitioned_vector laid out like v, every run of equal
+// keys is reduced to one (key, sum) pair. A run is reduced by the locality
+// where it starts, the first local element starts a run in any case.
+//
+// A run which straddles the boundary to the next locality is fixed up with a
+// single neighbour exchange: every locality sends the key of its last element
+// to its right neighbour and the key and sum of its first run to its left
+// neighbour. The left neighbour adds that sum to its last run if the keys
+// match, the right neighbour then drops its first run. A locality which holds
+// a single run forwards the sum received from the right to the left, so runs
+// over more than two localities are fixed up as well.
+//
+// Situation example (2 Localities, all values 2):
+// L0 keys 0 0 1 1   local runs (0, 4) (1, 4)
+// L1 keys 1 3 3 3   local runs (1, 2) (3, 6)
+// exchange: L0 adds 2 to (1, 4), L1 drops (1, 2)
+// result    L0 (0, 4) (1, 6)   L1 (3, 6)
+//
+// Run length distributions of the generated keys. Whether an element starts
+// a run depends on its global index only, the key of an element is the index
+// of the first element of its run.
+// constant:  runs of exactly mean_run_length elements
+// geometric: every element starts a run with probability 1 / mean_run_length
+// mixed:     like geometric, but the mean run length of every window of 2^16
+//            elements is 1, mean_run_length or 64 * mean_run_length
+//
+enum class run_length_distribution
+{
+    constant,
+    geometric,
+    mixed
+};
+
+run_length_distribution parse_run_length_distribution(std::string const& name)
+{
+    if (name == "constant")
+        return run_length_distribution::constant;
+    if (name == "geometric")
+        return run_length_distribution::geometric;
+    if (name == "mixed")
+        return run_length_distribution::mixed;
+    throw std::invalid_argument("unknown run_length_distribution: " + name);
+}
+
+// true if the element with the global index i starts a run
+inline bool is_run_head(std::uint64_t i, run_length_distribution distribution,
+    std::uint64_t mean_run_length)
+{
+    if (i == 0)
+        return true;
+
+    switch (distribution)
+    {
+    case run_length_distribution::constant:
+        return i % mean_run_length == 0;
+    case run_length_distribution::mixed:
+    {
+        std::uint64_t const window = splitmix64((i >> 16) ^ 0x5bd1e995) % 3;
+        std::uint64_t const mean = window == 0 ? 1 :
+            window == 1 ? mean_run_length : 64 * mean_run_length;
+        return splitmix64(i) % mean == 0;
+    }
+    case run_length_distribution::geometric:
+    default:
+        return splitmix64(i) % mean_run_length == 0;
+    }
+}
+
+// Keys of [first, first + count), the part of the vector which starts at the
+// global index offset. Every block searches the first element of the run it
+// starts in backwards. Returns the number of runs which start in the part.
+template <typename Iter>
+std::uint64_t generate_keys(Iter first, std::size_t count, std::uint64_t offset,
+    run_length_distribution distribution, std::uint64_t mean_run_length)
+{
+    std::size_t const num_blocks = (std::max)(std::size_t(1),
+        (std::min)(count, std::size_t(4 * hpx::get_num_worker_threads())));
+    std::size_t const block_size = (count + num_blocks - 1) / num_blocks;
+
+    std::vector<std::uint64_t> heads(num_blocks, 0);
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_blocks,
+        [&](std::size_t k) {
+            std::size_t const begin = (std::min)(k * block_size, count);
+            std::size_t const end = (std::min)(begin + block_size, count);
+            if (begin == end)
+                return;
+
+            std::uint64_t head = offset + begin;
+            while (!is_run_head(head, distribution, mean_run_length))
+            {
+                --head;
+            }
+            for (std::size_t i = begin; i != end; ++i)
+            {
+                if (is_run_head(offset + i, distribution, mean_run_length))
+                {
+                    head = offset + i;
+                    ++heads[k];
+                }
+                first[i] = static_cast<KEYTYPE>(head);
+            }
+        });
+    return std::accumulate(heads.begin(), heads.end(), std::uint64_t(0));
+}
+
+// Runs of [keys, keys + count) reduced to (key, sum) pairs in two parallel
+// passes over blocks: the runs which start in every block are counted, then
+// every block writes the sums of its runs behind the exclusive scan of the
+// counts. A run belongs to the block where it starts, including its elements
+// behind the end of the block.
+template <typename KeyIter, typename ValueIter>
+void reduce_runs(KeyIter keys, ValueIter values, std::size_t count,
+    std::vector<KEYTYPE>& run_keys, std::vector<VALUETYPE>& run_sums)
+{
+    std::size_t const num_blocks = (std::max)(std::size_t(1),
+        (std::min)(count, std::size_t(4 * hpx::get_num_worker_threads())));
+    std::size_t const block_size = (count + num_blocks - 1) / num_blocks;
+
+    auto is_head = [&](std::size_t i) { return i == 0 || keys[i] != keys[i - 1]; };
+
+    std::vector<std::size_t> heads(num_blocks + 1, 0);
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_blocks,
+        [&](std::size_t k) {
+            std::size_t const begin = (std::min)(k * block_size, count);
+            std::size_t const end = (std::min)(begin + block_size, count);
+            std::size_t n = 0;
+            for (std::size_t i = begin; i != end; ++i)
+            {
+                n += is_head(i);
+            }
+            heads[k + 1] = n;
+        });
+    std::partial_sum(heads.begin(), heads.end(), heads.begin());
+
+    run_keys.resize(heads[num_blocks]);
+    run_sums.resize(heads[num_blocks]);
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_blocks,
+        [&](std::size_t k) {
+            std::size_t const begin = (std::min)(k * block_size, count);
+            std::size_t const end = (std::min)(begin + block_size, count);
+            std::size_t i = begin;
+            while (i != end && !is_head(i))
+            {
+                ++i;
+            }
+            for (std::size_t out = heads[k]; i < end; ++out)
+            {
+                KEYTYPE const key = keys[i];
+                VALUETYPE sum = 0;
+                do
+                {
+                    sum += values[i];
+                    ++i;
+                } while (i != count && keys[i] == key);
+                run_keys[out] = key;
+                run_sums[out] = sum;
+            }
+        });
+}
+
+// Reduce-by-key of view_v with the keys view_keys, every locality needs at
+// least one element. The neighbour exchange of every round uses a generation
+// of its own on comm, like the all-reduce. expected_runs is the number of runs
+// which start in the local part according to the key generator.
+void run_by_key_benchmark(partitioned_vector_view<KEYTYPE>& view_keys,
+    partitioned_vector_view<VALUETYPE>& view_v, hpx::collectives::channel_communicator comm,
+    std::uint64_t expected_runs, int loop_count, int warmup_loop_count)
+{
+    using hpx::collectives::get;
+    using hpx::collectives::set;
+    using hpx::collectives::that_site_arg;
+
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const this_locality = hpx::get_locality_id();
+    std::size_t const count = view_v.size();
+    bool const has_left = this_locality != 0;
+    bool const has_right = this_locality + 1 != num_localities;
+
+    std::vector<KEYTYPE> run_keys;
+    std::vector<VALUETYPE> run_sums;
+    // 1 if the first local run is owned by the left neighbour
+    std::size_t first_owned = 0;
+
+    auto by_key_round = [&](std::size_t generation) {
+        reduce_runs(view_keys.begin(), view_v.begin(), count, run_keys, run_sums);
+        bool const single_run = run_keys.size() == 1;
+        first_owned = 0;
+
+        std::vector<hpx::future<void>> pending_sends;
+        if (has_right)
+        {
+            pending_sends.push_back(set(comm, that_site_arg(this_locality + 1),
+                KEYTYPE(view_keys[count - 1]), allreduce_tag(generation, 0, num_localities)));
+        }
+        if (has_left && !single_run)
+        {
+            pending_sends.push_back(set(comm, that_site_arg(this_locality - 1),
+                run_carry{run_keys.front(), run_sums.front()},
+                allreduce_tag(generation, 1, num_localities)));
+        }
+        if (has_right)
+        {
+            run_carry const right = get<run_carry>(comm, that_site_arg(this_locality + 1),
+                allreduce_tag(generation, 1, num_localities)).get();
+            if (right.key == run_keys.back())
+            {
+                run_sums.back() += right.sum;
+            }
+        }
+        // a single run forwards the sum of the right neighbour
+        if (has_left && single_run)
+        {
+            pending_sends.push_back(set(comm, that_site_arg(this_locality - 1),
+                run_carry{run_keys.front(), run_sums.front()},
+                allreduce_tag(generation, 1, num_localities)));
+        }
+        if (has_left)
+        {
+            KEYTYPE const left_key = get<KEYTYPE>(comm, that_site_arg(this_locality - 1),
+                allreduce_tag(generation, 0, num_localities)).get();
+            first_owned = left_key == run_keys.front() ? 1 : 0;
+        }
+
+        for (auto& f : pending_sends)
+        {
+            f.get();
+        }
+    };
+
+    std::size_t generation = 0;
+    for (int round = 1; round <= warmup_loop_count; ++round) {
+        by_key_round(++generation);
+    }
+
+    //start timer
+    hpx::chrono::high_resolution_timer t;
+
+    for (int round = 1; round <= loop_count; ++round) {
+        by_key_round(++generation);
+    }
+
+    //end timer
+    double elapsed = t.elapsed() / loop_count;
+    hpx::util::format_to(std::cout,
+            "Elapsed Time == {1} [s]\n",
+            elapsed);
+    // keys and values are read
+    hpx::util::format_to(std::cout,
+            "Bandwidth == {1} [GB/s]\n",
+            count * (sizeof(KEYTYPE) + sizeof(VALUETYPE)) / elapsed / 1e9);
+    hpx::util::format_to(std::cout,
+            "Element Rate == {1} [Gelements/s]\n",
+            count / elapsed / 1e9);
+
+    // check the number of runs and their total sum against the generator
+    auto all_sum = [&](auto local) {
+        std::vector<hpx::future<void>> pending_sends;
+        auto result = all_reduce_localities(comm, num_localities, this_locality, local,
+            std::plus<decltype(local)>(), allreduce_algorithm::tree, ++generation, pending_sends);
+        for (auto& f : pending_sends)
+        {
+            f.get();
+        }
+        return result;
+    };
+    std::uint64_t const runs = all_sum(std::uint64_t(run_keys.size() - first_owned));
+    double const sum = all_sum(std::accumulate(run_sums.begin() + first_owned, run_sums.end(), 0.0));
+    std::uint64_t const all_expected_runs = all_sum(expected_runs);
+    double const expected_sum = all_sum(2.0 * count);
+
+    if (0 == this_locality)
+    {
+        hpx::util::format_to(std::cout,
+                "Runs == {1} (expected {2})\n"
+                "Mean Run Length == {3}\n"
+                "Sum == {4} (expected {5})\n",
+                runs, all_expected_runs, expected_sum / 2 / runs, sum, expected_sum);
+    }
+}
+ 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Histogram.
+//
+// Every locality counts the elements of its part of the vector in num_bins
+// equally wide bins of [0, 1). The histograms of the localities are summed up
+// with the all-reduce, so every locality ends up with the global histogram.
+//
+// atomic:     one shared histogram, every thread increments the bins with
+//             atomic additions. Contended if there are few bins or hot bins.
+// privatized: every worker thread counts in a private histogram, the private
+//             histograms are summed up in a parallel pass over the bins. No
+//             contention, but the merge reads num_workers * num_bins counters.
+//             Above privatized_max_counters counters the bin counts fall back
+//             to the atomic method instead (reported as Method), so the
+//             private histograms take at most 1 GiB.
+// numa:       one shared histogram per NUMA domain, allocated and incremented
+//             by the cores of the domain only, the domain histograms are
+//             summed up like the private ones. Every domain counts its slice
+//             of a copy of the local part placed on the domain (numa_slices).
+//
+// The values are generated from their global index. A fraction bin_skew of
+// them falls into bin 0 (the hot bin), the others are uniform over the bins.
+//
+// Situation example (2 Localities, 4 bins):
+// L0 values 0.1 0.3 0.6 0.9   local histogram 1 1 1 1
+// L1 values 0.0 0.0 0.2 0.7   local histogram 3 0 1 0
+// global histogram on L0 and L1              4 1 2 1
+//
+enum class histogram_method
+{
+    atomic,
+    privatized,
+    numa
+};
+
+histogram_method parse_histogram_method(std::string const& name)
+{
+    if (name == "atomic")
+        return histogram_method::atomic;
+    if (name == "privatized")
+        return histogram_method::privatized;
+    if (name == "numa")
+        return histogram_method::numa;
+    throw std::invalid_argument("unknown histogram_method: " + name);
+}
+
+char const* histogram_method_name(histogram_method method)
+{
+    switch (method)
+    {
+    case histogram_method::atomic:
+        return "atomic";
+    case histogram_method::privatized:
+        return "privatized";
+    case histogram_method::numa:
+    default:
+        return "numa";
+    }
+}
+
+// largest num_workers * num_bins of the privatized method (1 GiB of counters)
+constexpr std::size_t privatized_max_counters = std::size_t(1) << 27;
+
+// value of the element with the global index i, the lower 24 bits of the hash
+// decide whether it is hot, the upper 24 bits are the value
+inline VALUETYPE histogram_value(std::uint64_t i, double bin_skew)
+{
+    std::uint64_t const r = splitmix64(i ^ 0x2545f4914f6cdd1dull);
+    if ((r & 0xffffff) < bin_skew * 0x1000000)
+        return 0;
+    return static_cast<VALUETYPE>(r >> 40) * 0x1p-24f;
+}
+
+inline std::size_t histogram_bin(VALUETYPE x, std::size_t num_bins)
+{
+    return (std::min)(static_cast<std::size_t>(x * num_bins), num_bins - 1);
+}
+
+// sums up the histograms of two localities
+struct histogram_add
+{
+    std::vector<std::uint64_t> operator()(std::vector<std::uint64_t> a,
+        std::vector<std::uint64_t> const& b) const
+    {
+        for (std::size_t i = 0; i != a.size(); ++i)
+        {
+            a[i] += b[i];
+        }
+        return a;
+    }
+
+    template <typename Archive>
+    void serialize(Archive&, unsigned int)
+    {
+    }
+};
+
+// counts [first, last) in the shared histogram bins with policy
+template <typename ExPolicy, typename Iter>
+void count_atomic(ExPolicy&& policy, Iter first, Iter last,
+    std::atomic<std::uint64_t>* bins, std::size_t num_bins)
+{
+    hpx::for_each(policy, first, last, [=](VALUETYPE x) {
+        bins[histogram_bin(x, num_bins)].fetch_add(1, std::memory_order_relaxed);
+    });
+}
+
+// result[b] = sum of partials[k][b] over all k, in parallel over the bins
+template <typename Partials>
+void merge_histograms(Partials const& partials, std::vector<std::uint64_t>& result)
+{
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), result.size(),
+        [&](std::size_t b) {
+            std::uint64_t sum = 0;
+            for (auto const& partial : partials)
+            {
+                sum += partial[b];
+            }
+            result[b] = sum;
+        });
+}
+
+// Histogram of view with every bin count of bin_counts. hierarchy is only
+// used by the numa method, the global merge of every round uses a generation
+// of its own on comm. Locality 0 prints the rates, the time of the local
+// counting and of the global merge and checks the global histogram.
+void run_histogram_benchmark(partitioned_vector_view<VALUETYPE>& view,
+    numa_hierarchy* hierarchy, hpx::collectives::channel_communicator comm,
+    histogram_method method, std::vector<std::size_t> const& bin_counts,
+    double bin_skew, std::uint64_t total, allreduce_algorithm algorithm,
+    int loop_count, int warmup_loop_count)
+{
+    using atomic_bins = std::unique_ptr<std::atomic<std::uint64_t>[]>;
+    using iterator = partitioned_vector_view<VALUETYPE>::iterator;
+
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const this_locality = hpx::get_locality_id();
+    std::size_t const count = view.size();
+    std::size_t const num_workers = hpx::get_num_worker_threads();
+    iterator const first = view.begin();
+
+    // numa: the slices of the NUMA domains, placed on their domain
+    std::optional<numa_slices<VALUETYPE>> data;
+    if (method == histogram_method::numa)
+    {
+        data.emplace(*hierarchy, view);
+    }
+
+    std::size_t generation = 0;
+    for (std::size_t num_bins : bin_counts)
+    {
+        std::vector<std::uint64_t> histogram(num_bins);
+        histogram_method const bins_method =
+            (method == histogram_method::privatized && num_workers * num_bins > privatized_max_counters) ?
+            histogram_method::atomic : method;
+
+        // shared histogram of the atomic method
+        atomic_bins shared;
+        // private histograms of the privatized method, one per worker thread
+        std::vector<std::vector<std::uint64_t>> privates;
+        // histograms of the numa method, allocated on the cores of their domain
+        std::vector<atomic_bins> domains;
+        switch (bins_method)
+        {
+        case histogram_method::atomic:
+            shared.reset(new std::atomic<std::uint64_t>[num_bins]);
+            break;
+        case histogram_method::privatized:
+            privates.resize(num_workers);
+            break;
+        case histogram_method::numa:
+        {
+            domains.resize(hierarchy->size());
+            std::vector<hpx::future<void>> allocated;
+            for (std::size_t d = 0; d != hierarchy->size(); ++d)
+            {
+                allocated.push_back(hpx::async(hierarchy->executors[d], [&, d]() {
+                    domains[d].reset(new std::atomic<std::uint64_t>[num_bins]);
+                }));
+            }
+            hpx::wait_all(allocated);
+            break;
+        }
+        }
+
+        double local_time = 0;
+        double merge_time = 0;
+
+        auto histogram_round = [&]() {
+            hpx::chrono::high_resolution_timer t_local;
+            switch (bins_method)
+            {
+            case histogram_method::atomic:
+            {
+                hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_bins,
+                    [&](std::size_t b) { shared[b].store(0, std::memory_order_relaxed); });
+                count_atomic(hpx::execution::par, first, first + count, shared.get(), num_bins);
+                hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_bins,
+                    [&](std::size_t b) { histogram[b] = shared[b].load(std::memory_order_relaxed); });
+                break;
+            }
+            case histogram_method::privatized:
+            {
+                // one block of the vector per private histogram
+                hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_workers,
+                    [&](std::size_t k) {
+                        std::vector<std::uint64_t>& bins = privates[k];
+                        bins.assign(num_bins, 0);
+                        std::size_t const begin = count * k / num_workers;
+                        std::size_t const end = count * (k + 1) / num_workers;
+                        for (std::size_t i = begin; i != end; ++i)
+                        {
+                            ++bins[histogram_bin(first[i], num_bins)];
+                        }
+                    });
+                merge_histograms(privates, histogram);
+                break;
+            }
+            case histogram_method::numa:
+            {
+                std::vector<hpx::future<void>> counted;
+                for (std::size_t d = 0; d != hierarchy->size(); ++d)
+                {
+                    counted.push_back(hpx::async(hierarchy->executors[d], [&, d]() {
+                        auto policy = hpx::execution::par.on(hierarchy->executors[d]);
+                        std::atomic<std::uint64_t>* bins = domains[d].get();
+                        hpx::experimental::for_loop(policy, std::size_t(0), num_bins,
+                            [=](std::size_t b) { bins[b].store(0, std::memory_order_relaxed); });
+                        count_atomic(policy, data->slices[d].begin(), data->slices[d].end(), bins, num_bins);
+                    }));
+                }
+                hpx::wait_all(counted);
+                std::vector<std::atomic<std::uint64_t>*> partials;
+                for (atomic_bins const& bins : domains)
+                {
+                    partials.push_back(bins.get());
+                }
+                merge_histograms(partials, histogram);
+                break;
+            }
+            }
+            local_time += t_local.elapsed();
+
+            hpx::chrono::high_resolution_timer t_merge;
+            std::vector<hpx::future<void>> pending_sends;
+            histogram = all_reduce_localities(comm, num_localities, this_locality,
+                histogram, histogram_add(), algorithm, ++generation, pending_sends);
+            for (auto& f : pending_sends)
+            {
+                f.get();
+            }
+            merge_time += t_merge.elapsed();
+        };
+
+        for (int round = 1; round <= warmup_loop_count; ++round) {
+            histogram_round();
+        }
+        local_time = 0;
+        merge_time = 0;
+
+        //start timer
+        hpx::chrono::high_resolution_timer t;
+
+        for (int round = 1; round <= loop_count; ++round) {
+            histogram_round();
+        }
+
+        //end timer
+        double elapsed = t.elapsed() / loop_count;
+
+        if (0 == this_locality)
+        {
+            std::uint64_t const counted =
+                std::accumulate(histogram.begin(), histogram.end(), std::uint64_t(0));
+            hpx::util::format_to(std::cout,
+                    "Bins == {1}\n"
+                    "Method == {11}\n"
+                    "Elapsed Time == {2} [s]\n"
+                    "Bandwidth == {3} [GB/s]\n"
+                    "Element Rate == {4} [Gelements/s]\n"
+                    "Local Time == {5} [s]\n"
+                    "Merge Time == {6} [s]\n"
+                    "Count == {7} (expected {8})\n"
+                    "Hot Bin Count == {9} (expected about {10})\n",
+                    num_bins, elapsed, total * sizeof(VALUETYPE) / elapsed / 1e9,
+                    total / elapsed / 1e9, local_time / loop_count, merge_time / loop_count,
+                    counted, total, histogram[0],
+                    total * (bin_skew + (1 - bin_skew) / num_bins),
+                    histogram_method_name(bins_method));
+        }
+    }
+}
+ 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Compressed storage.
+//
+// The vector holds 32 bit unsigned integers compressed in blocks of
+// numa::block_size values, stored as a partitioned_vector of 32 bit words.
+// The formats and the block layout are those of include/compressed.hpp: a
+// block is decoded row by row and every row is handed to the kernel while it
+// is still in registers, the decoded values never go to memory. The
+// compressed formats read fewer bytes per element, so the elements per second
+// of the memory bound kernels grow with the compression ratio as long as
+// decoding keeps up with the memory.
+//
+// uint32:    the values uncompressed, the baseline
+// bitpacked: the values with Bits bits each
+// delta_for: delta plus frame of reference with Bits bits per entry
+//
+// The values are the example blocks of the format, generated from the global
+// block index.
+//
+// Situation example (delta_for, blocks of 3 rows of 2 lanes):
+// rows      (100 104) (102 107) (105 109)
+// header    base (100 104)   reference (2 2)
+// entries   row 1 (0 1)   row 2 (1 0)
+//
+enum class compression_format
+{
+    uint32,
+    bitpacked,
+    delta_for
+};
+
+compression_format parse_compression_format(std::string const& name)
+{
+    if (name == "uint32")
+        return compression_format::uint32;
+    if (name == "bitpacked")
+        return compression_format::bitpacked;
+    if (name == "delta_for")
+        return compression_format::delta_for;
+    throw std::invalid_argument("unknown compression format: " + name);
+}
+
+template <int Bits, typename F>
+void with_compressed_bits(compression_format format, F&& f)
+{
+    if (format == compression_format::bitpacked)
+        f(bitpacked_format<Bits>());
+    else
+        f(delta_for_format<Bits>());
+}
+
+// Calls f with the format object of format and bits, the compressed formats
+// are instantiated for 4, 8, 12, 16 and 24 bits.
+template <typename F>
+void with_compression_format(compression_format format, int bits, F&& f)
+{
+    if (format == compression_format::uint32)
+    {
+        f(uncompressed_format());
+        return;
+    }
+    switch (bits)
+    {
+    case 4:
+        with_compressed_bits<4>(format, f);
+        break;
+    case 8:
+        with_compressed_bits<8>(format, f);
+        break;
+    case 12:
+        with_compressed_bits<12>(format, f);
+        break;
+    case 16:
+        with_compressed_bits<16>(format, f);
+        break;
+    case 24:
+        with_compressed_bits<24>(format, f);
+        break;
+    default:
+        throw std::invalid_argument(
+            "compressed_bits has to be 4, 8, 12, 16 or 24: " + std::to_string(bits));
+    }
+}
+
+// Number of blocks per locality for size values, the blocks do not straddle
+// partitions.
+inline std::size_t compressed_local_blocks(std::size_t size, std::size_t num_localities)
+{
+    std::size_t const per_locality = num_localities * numa::block_size;
+    return (std::max)(std::size_t(1), (size + per_locality - 1) / per_locality);
+}
+
+// Sum of the blocks [first, last) on a single thread, every block is decoded
+// row by row and the rows are added up in numa::block_lanes lanes.
+template <typename Format>
+std::uint64_t compressed_sum(compressed_word const* words, std::size_t first, std::size_t last)
+{
+    std::uint64_t sum[numa::block_lanes] = {};
+    for (std::size_t b = first; b != last; ++b)
+    {
+        Format::decode(words + b * Format::block_words,
+            [&](std::size_t, std::uint32_t const* row) {
+                for (std::size_t l = 0; l != numa::block_lanes; ++l)
+                {
+                    sum[l] += row[l];
+                }
+            });
+    }
+    return std::accumulate(sum, sum + numa::block_lanes, std::uint64_t(0));
+}
+
+// Sum kernel over size values (rounded up to whole blocks on every locality)
+// in format with every bit count of bit_counts. The vector of words has the
+// size of the uncompressed values, a format uses the front of every
+// partition. The sums are exact modulo 2^64, the localities are combined with
+// the all-reduce of algorithm. All localities print their times, locality 0
+// the result.
+void run_compressed_reduction(std::size_t size, compression_format format,
+    std::vector<int> const& bit_counts, int loop_count, int warmup_loop_count,
+    allreduce_algorithm algorithm)
+{
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const this_locality = hpx::get_locality_id();
+    std::size_t const local_blocks = compressed_local_blocks(size, num_localities);
+    std::size_t const elements = num_localities * local_blocks * numa::block_size;
+
+    char const* const vector_name = "compressed_vector";
+    char const* const allreduce_channel_name = "compressed_allreduce_channel";
+
+    hpx::partitioned_vector<compressed_word> v;
+    if (0 == this_locality)
+    {
+        std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+        v = hpx::partitioned_vector<compressed_word>(elements, hpx::container_layout(localities));
+        v.register_as(vector_name);
+    }
+    else
+    {
+        hpx::future<void> f1 = v.connect_to(vector_name);
+        f1.get();
+    }
+
+    partitioned_vector_view<compressed_word> view_v(v);
+    compressed_word* const words = &*view_v.begin();
+    std::size_t const first_block = view_v.offset() / numa::block_size;
+
+    hpx::collectives::channel_communicator allreduce_comm =
+        hpx::collectives::create_channel_communicator(hpx::launch::sync,
+            allreduce_channel_name,
+            hpx::collectives::num_sites_arg(num_localities),
+            hpx::collectives::this_site_arg(this_locality));
+
+    std::size_t generation = 0;
+    auto all_reduce = [&](std::uint64_t local) {
+        std::vector<hpx::future<void>> pending_sends;
+        std::uint64_t const result = all_reduce_localities(allreduce_comm, num_localities,
+            this_locality, local, std::plus<std::uint64_t>(), algorithm, ++generation,
+            pending_sends);
+        for (auto& f : pending_sends)
+        {
+            f.get();
+        }
+        return result;
+    };
+
+    for (int bits : bit_counts)
+    {
+        with_compression_format(format, bits, [&](auto format_type) {
+            using format_t = decltype(format_type);
+            auto const first = hpx::util::make_counting_iterator(std::size_t(0));
+            auto const last = hpx::util::make_counting_iterator(local_blocks);
+
+            // encode the local blocks, expected is the sum of their values
+            std::uint64_t const expected = all_reduce(hpx::transform_reduce(
+                hpx::execution::par, first, last, std::uint64_t(0),
+                std::plus<std::uint64_t>(), [&](std::size_t b) {
+                    std::uint32_t values[numa::block_size];
+                    format_t::example_block(first_block + b, values);
+                    format_t::encode(values, words + b * format_t::block_words);
+                    return std::accumulate(values, values + numa::block_size,
+                        std::uint64_t(0));
+                }));
+
+            auto reduction_round = [&]() {
+                return all_reduce(reduce_blocks(hpx::execution::par,
+                    hpx::get_num_worker_threads(), first, last, std::uint64_t(0),
+                    [&](auto block_first, auto block_last) {
+                        return compressed_sum<format_t>(words, *block_first, *block_last);
+                    },
+                    std::plus<std::uint64_t>()));
+            };
+
+            for (int round = 1; round <= warmup_loop_count; ++round) {
+                reduction_round();
+            }
+
+            //start timer
+            hpx::chrono::high_resolution_timer t;
+
+            std::uint64_t result = 0;
+            for (int round = 1; round <= loop_count; ++round) {
+                result = reduction_round();
+            }
+
+            //end timer
+            double elapsed = t.elapsed() / loop_count;
+            double const compressed_bytes =
+                double(num_localities * local_blocks * format_t::block_words) * sizeof(compressed_word);
+            hpx::util::format_to(std::cout,
+                    "Compressed Bits == {1}\n"
+                    "Elapsed Time == {2} [s]\n"
+                    "Bandwidth == {3} [GB/s]\n"
+                    "Element Rate == {4} [Gelements/s]\n"
+                    "Compression Ratio == {5}\n",
+                    format_t::bits, elapsed, compressed_bytes / elapsed / 1e9,
+                    elements / elapsed / 1e9,
+                    double(numa::block_size) / format_t::block_words);
+
+            if (0 == this_locality)
+            {
+                std::cout << "Reduction Result == " << result << std::endl;
+                hpx::util::format_to(std::cout,
+                        "Errors == {1}\n",
+                        result == expected ? 0 : 1);
+            }
+        });
+    }
+}
+ 
+///////////////////////////////////////////////////////////////////////////////
+int hpx_main(hpx::program_options::variables_map& vm)
+{
+    VALUETYPE size = vm["maxelems"].as<VALUETYPE>();
+    int loop_count = vm["loop_count"].as<int>();
+    int warmup_loop_count = vm["warmup_loop_count"].as<int>();
+    reduction_mode mode = parse_reduction_mode(vm["reduction_mode"].as<std::string>());
+    reduction_kernel kernel = parse_reduction_kernel(vm["reduction_kernel"].as<std::string>());
+    summation_mode summation = parse_summation_mode(vm["summation"].as<std::string>());
+    allreduce_algorithm algorithm =
+        parse_allreduce_algorithm(vm["allreduce_algorithm"].as<std::string>());
+    local_reduction local = parse_local_reduction(vm["local_reduction"].as<std::string>());
+    std::size_t const num_in_flight = vm["in_flight"].as<std::size_t>();
+    std::size_t const row_length = vm["row_length"].as<std::size_t>();
+    std::string const storage = vm["storage"].as<std::string>();
+    run_length_distribution distribution =
+        parse_run_length_distribution(vm["run_length_distribution"].as<std::string>());
+    std::uint64_t const mean_run_length = vm["mean_run_length"].as<std::uint64_t>();
+    if (mean_run_length == 0)
+    {
+        throw std::invalid_argument("mean_run_length has to be at least 1");
+    }
+    std::string const accumulate = vm["accumulate"].as<std::string>();
+    int const compressed_bits = vm["compressed_bits"].as<int>();
+    histogram_method const histogram = parse_histogram_method(vm["histogram_method"].as<std::string>());
+    std::size_t const num_bins = vm["num_bins"].as<std::size_t>();
+    double const bin_skew = vm["bin_skew"].as<double>();
+    if (bin_skew < 0 || bin_skew > 1)
+    {
+        throw std::invalid_argument("bin_skew has to be in [0, 1]");
+    }
+    
+    // compressed integer storage: plain sum over the decoded blocks
+    if (storage == "uint32" || storage == "bitpacked" || storage == "delta_for")
+    {
+        if (kernel != reduction_kernel::sum || summation != summation_mode::plain ||
+            local != local_reduction::flat || accumulate != "float")
+        {
+            throw std::invalid_argument(
+                "compressed storage supports the plain sum with the flat local reduction only");
+        }
+        if (mode != reduction_mode::allreduce)
+        {
+            throw std::invalid_argument(
+                "compressed storage combines the localities with the all-reduce only, use --reduction_mode allreduce");
+        }
+        compression_format const format = parse_compression_format(storage);
+        std::vector<int> bit_counts(1, format == compression_format::uint32 ? 32 : compressed_bits);
+        if (format != compression_format::uint32 && compressed_bits == 0)
+        {
+            bit_counts = {4, 8, 12, 16, 24};
+        }
+        if (0 == hpx::get_locality_id())
+        {
+            hpx::cout << "Reduction Vector Size: " << size << "\n" << std::flush;
+            hpx::cout << "Reduction Mode: " << vm["reduction_mode"].as<std::string>() << "\n" << std::flush;
+            hpx::cout << "Storage: " << storage << "\n" << std::flush;
+            hpx::cout << "Allreduce Algorithm: " << vm["allreduce_algorithm"].as<std::string>() << "\n" << std::flush;
+        }
+
+        run_compressed_reduction(static_cast<std::size_t>(size), format, bit_counts,
+            loop_count, warmup_loop_count, algorithm);
+        return hpx::finalize();
+    }
+
+    // reduced precision storage or double accumulation: plain sum only
+    if (storage != "float" || accumulate != "float")
+    {
+        if (kernel != reduction_kernel::sum || summation != summation_mode::plain ||
+            local != local_reduction::flat || mode == reduction_mode::async)
+        {
+            throw std::invalid_argument(
+                "storage and accumulate support the plain sum with the flat local reduction only");
+        }
+        if (0 == hpx::get_locality_id())
+        {
+            hpx::cout << "Reduction Vector Size: " << size << "\n" << std::flush;
+            hpx::cout << "Reduction Mode: " << vm["reduction_mode"].as<std::string>() << "\n" << std::flush;
+            hpx::cout << "Storage: " << storage << "\n" << std::flush;
+            hpx::cout << "Accumulate: " << accumulate << "\n" << std::flush;
+        }
+        
+        auto run = [&](auto storage_type) {
+            using storage_type_t = decltype(storage_type);
+            if (accumulate == "float")
+                run_storage_reduction<storage_type_t, float>(static_cast<std::size_t>(size), loop_count, warmup_loop_count, mode, algorithm);
+            else if (accumulate == "double")
+                run_storage_reduction<storage_type_t, double>(static_cast<std::size_t>(size), loop_count, warmup_loop_count, mode, algorithm);
+            else
+                throw std::invalid_argument("unknown accumulate: " + accumulate);
+        };
+        if (storage == "float")
+            run(VALUETYPE());
+        else if (storage == "bf16")
+            run(bfloat16());
+        else if (storage == "fp16")
+            run(float16());
+        else if (storage == "int16")
+            run(int16_scaled());
+        else if (storage == "int8")
+            run(int8_scaled());
+        else
+            throw std::invalid_argument("unknown storage: " + storage);
+        return hpx::finalize();
+    }
+    
+    if (mode == reduction_mode::async && (kernel != reduction_kernel::sum ||
+            summation != summation_mode::plain || local != local_reduction::flat))
+    {
+        throw std::invalid_argument(
+            "the async reduction_mode supports the plain sum with the flat local reduction only");
+    }
+    // reduce-by-key combines the localities with its own neighbour exchange,
+    // an explicit reduction_mode would be ignored
+    if (kernel == reduction_kernel::by_key && !vm["reduction_mode"].defaulted())
+    {
+        throw std::invalid_argument(
+            "the by_key kernel combines the localities with its neighbour exchange, reduction_mode does not apply");
+    }
+    if (num_in_flight == 0)
+    {
+        throw std::invalid_argument("in_flight has to be at least 1");
+    }
+    
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const this_locality = hpx::get_locality_id();
+    
+    //print vector size
+    if (0 == hpx::get_locality_id())
+    {
+        hpx::cout << "Reduction Vector Size: " << size << "\n" << std::flush;
+        if (kernel != reduction_kernel::by_key)
+        {
+            hpx::cout << "Reduction Mode: " << vm["reduction_mode"].as<std::string>() << "\n" << std::flush;
+        }
+        hpx::cout << "Reduction Kernel: " << vm["reduction_kernel"].as<std::string>() << "\n" << std::flush;
+        if (kernel == reduction_kernel::rows)
+        {
+            hpx::cout << "Row Length: " << row_length << "\n" << std::flush;
+        }
+        if (kernel == reduction_kernel::by_key)
+        {
+            hpx::cout << "Run Length Distribution: " << vm["run_length_distribution"].as<std::string>() << "\n" << std::flush;
+            hpx::cout << "Mean Run Length: " << mean_run_length << "\n" << std::flush;
+        }
+        if (kernel == reduction_kernel::histogram)
+        {
+            hpx::cout << "Histogram Method: " << vm["histogram_method"].as<std::string>() << "\n" << std::flush;
+            hpx::cout << "Bin Skew: " << bin_skew << "\n" << std::flush;
+        }
+        if (kernel == reduction_kernel::sum)
+        {
+            hpx::cout << "Summation: " << vm["summation"].as<std::string>() << "\n" << std::flush;
+        }
+        if (mode == reduction_mode::async)
+        {
+            hpx::cout << "Reductions in Flight: " << num_in_flight << "\n" << std::flush;
+        }
+        if (mode != reduction_mode::barrier || kernel == reduction_kernel::histogram)
+        {
+            hpx::cout << "Allreduce Algorithm: " << vm["allreduce_algorithm"].as<std::string>() << "\n" << std::flush;
+        }
+        hpx::cout << "Local Reduction: " << vm["local_reduction"].as<std::string>() << "\n" << std::flush;
+    }
+ 
+    char const* const vector_name_1 =
+        "v_vector";
+    char const* const vector_name_2 =
+        "sums_per_locality_vector";
+    char const* const vector_name_3 =
+        "statistics_per_locality_vector";
+    char const* const vector_name_4 =
+        "compensated_sums_per_locality_vector";
+    char const* const vector_name_5 =
+        "binned_sums_per_locality_vector";
+    char const* const vector_name_6 =
+        "extrema_per_locality_vector";
+    char const* const vector_name_7 =
+        "keys_vector";
+    char const* const allreduce_channel_name =
+        "reduction_allreduce_channel";
+    char const* const by_key_channel_name =
+        "reduction_by_key_channel";
+    char const* const histogram_channel_name =
+        "reduction_histogram_channel";
+ 
+    // row reductions, every locality works on its own rows only
+    if (kernel == reduction_kernel::rows)
+    {
+        // row_length 0 sweeps 1 KiB to 64 KiB rows
+        std::vector<std::size_t> row_lengths(1, row_length);
+        if (row_length == 0)
+        {
+            row_lengths.clear();
+            for (std::size_t length = 256; length <= 16384; length *= 2)
+            {
+                row_lengths.push_back(length);
+            }
+        }
+        run_row_benchmark(static_cast<std::size_t>(size), row_lengths,
+            loop_count, warmup_loop_count);
+    }
+    else
+    {
+        // create vector on one locality, connect to it from all others
+        hpx::partitioned_vector<VALUETYPE> v;
+        hpx::partitioned_vector<VALUETYPE> sums_per_locality;
+        // only used by the statistics kernel
+        hpx::partitioned_vector<statistics> statistics_per_locality;
+        // only used by the minmaxloc kernel
+        hpx::partitioned_vector<extremum_location> extrema_per_locality;
+        // only used by the by_key kernel, laid out like v
+        hpx::partitioned_vector<KEYTYPE> keys;
+        // only used by the compensated and reproducible summation
+        hpx::partitioned_vector<compensated_sum> compensated_sums_per_locality;
+        hpx::partitioned_vector<binned_sum> binned_sums_per_locality;
+        bool const compensated = kernel == reduction_kernel::sum && summation == summation_mode::compensated;
+        bool const reproducible = kernel == reduction_kernel::sum && summation == summation_mode::reproducible;
+        
+        if (0 == hpx::get_locality_id())
+        {
+            std::vector<hpx::id_type> localities = hpx::find_all_localities();
+            
+            v = hpx::partitioned_vector<VALUETYPE>(
+                                              size, hpx::container_layout(localities));
+            v.register_as(vector_name_1);
+
+            sums_per_locality = hpx::partitioned_vector<VALUETYPE>(localities.size(), hpx::container_layout(localities));
+            sums_per_locality.register_as(vector_name_2);
+
+            if (kernel == reduction_kernel::statistics)
+            {
+                statistics_per_locality = hpx::partitioned_vector<statistics>(localities.size(), hpx::container_layout(localities));
+                statistics_per_locality.register_as(vector_name_3);
+            }
+            if (kernel == reduction_kernel::minmaxloc)
+            {
+                extrema_per_locality = hpx::partitioned_vector<extremum_location>(localities.size(), hpx::container_layout(localities));
+                extrema_per_locality.register_as(vector_name_6);
+            }
+            if (kernel == reduction_kernel::by_key)
+            {
+                keys = hpx::partitioned_vector<KEYTYPE>(size, hpx::container_layout(localities));
+                keys.register_as(vector_name_7);
+            }
+            if (compensated)
+            {
+                compensated_sums_per_locality = hpx::partitioned_vector<compensated_sum>(localities.size(), hpx::container_layout(localities));
+                compensated_sums_per_locality.register_as(vector_name_4);
+            }
+            if (reproducible)
+            {
+                binned_sums_per_locality = hpx::partitioned_vector<binned_sum>(localities.size(), hpx::container_layout(localities));
+                binned_sums_per_locality.register_as(vector_name_5);
+            }
+        }
+        else
+        {
+            hpx::future<void> f1 = v.connect_to(vector_name_1);
+            hpx::future<void> f2 = sums_per_locality.connect_to(vector_name_2);
+            f1.get();
+            f2.get();
+
+            if (kernel == reduction_kernel::statistics)
+            {
+                statistics_per_locality.connect_to(vector_name_3).get();
+            }
+            if (kernel == reduction_kernel::minmaxloc)
+            {
+                extrema_per_locality.connect_to(vector_name_6).get();
+            }
+            if (kernel == reduction_kernel::by_key)
+            {
+                keys.connect_to(vector_name_7).get();
+            }
+            if (compensated)
+            {
+                compensated_sums_per_locality.connect_to(vector_name_4).get();
+            }
+            if (reproducible)
+            {
+                binned_sums_per_locality.connect_to(vector_name_5).get();
+            }
+        }
+
+        // views of the element of this locality in the per-locality vectors,
+        // built once outside of the measurement
+        partitioned_vector_view<VALUETYPE> view_sums(sums_per_locality);
+        std::optional<partitioned_vector_view<statistics>> view_statistics;
+        std::optional<partitioned_vector_view<extremum_location>> view_extrema;
+        std::optional<partitioned_vector_view<compensated_sum>> view_compensated_sums;
+        std::optional<partitioned_vector_view<binned_sum>> view_binned_sums;
+        if (kernel == reduction_kernel::statistics)
+        {
+            view_statistics.emplace(statistics_per_locality);
+        }
+        if (kernel == reduction_kernel::minmaxloc)
+        {
+            view_extrema.emplace(extrema_per_locality);
+        }
+        if (compensated)
+        {
+            view_compensated_sums.emplace(compensated_sums_per_locality);
+        }
+        if (reproducible)
+        {
+            view_binned_sums.emplace(binned_sums_per_locality);
+        }
+
+        // NUMA domains of this locality, only used by the numa local reduction
+        // and the numa histogram
+        std::unique_ptr<numa_hierarchy> hierarchy;
+        if (local == local_reduction::numa ||
+            (kernel == reduction_kernel::histogram && histogram == histogram_method::numa))
+        {
+            hierarchy.reset(new numa_hierarchy);
+        }
+        level_timings timings(hierarchy ? hierarchy->size() : 0);
+
+        // fill vector v with numbers 2, the summation modes of the sum kernel
+        // with summation_value instead. The numa local reduction copies the
+        // slices to their domains later (see numa_slices)
+        partitioned_vector_view<VALUETYPE> view_v(v);
+        bool const mixed_values = kernel == reduction_kernel::sum && summation != summation_mode::plain;
+        {
+            partitioned_vector_view<VALUETYPE>::iterator const first_v = view_v.begin();
+            hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), view_v.size(),
+                [&](std::size_t i) {
+                    first_v[i] = mixed_values ? summation_value(view_v.offset() + i) : VALUETYPE(2);
+                });
+        }
+        
+        // histogram: values in [0, 1) instead, counted with bin_counts bins
+        if (kernel == reduction_kernel::histogram)
+        {
+            partitioned_vector_view<VALUETYPE>::iterator const first_v = view_v.begin();
+            hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), view_v.size(),
+                [&](std::size_t i) {
+                    first_v[i] = histogram_value(view_v.offset() + i, bin_skew);
+                });
+            
+            // num_bins 0 sweeps 16 to 2^20 bins
+            std::vector<std::size_t> bin_counts(1, num_bins);
+            if (num_bins == 0)
+            {
+                bin_counts.clear();
+                for (std::size_t bins = 16; bins <= (std::size_t(1) << 20); bins *= 4)
+                {
+                    bin_counts.push_back(bins);
+                }
+            }
+            hpx::collectives::channel_communicator histogram_comm =
+                hpx::collectives::create_channel_communicator(hpx::launch::sync,
+                    histogram_channel_name,
+                    hpx::collectives::num_sites_arg(num_localities),
+                    hpx::collectives::this_site_arg(this_locality));
+            run_histogram_benchmark(view_v, hierarchy.get(), histogram_comm, histogram,
+                bin_counts, bin_skew, static_cast<std::uint64_t>(size), algorithm,
+                loop_count, warmup_loop_count);
+        }
+        // reduce-by-key over the sorted keys, values v
+        else if (kernel == reduction_kernel::by_key)
+        {
+            partitioned_vector_view<KEYTYPE> view_keys(keys);
+            std::uint64_t const expected_runs = generate_keys(view_keys.begin(), view_keys.size(),
+                view_keys.offset(), distribution, mean_run_length);
+            hpx::collectives::channel_communicator by_key_comm =
+                hpx::collectives::create_channel_communicator(hpx::launch::sync,
+                    by_key_channel_name,
+                    hpx::collectives::num_sites_arg(num_localities),
+                    hpx::collectives::this_site_arg(this_locality));
+            run_by_key_benchmark(view_keys, view_v, by_key_comm, expected_runs,
+                loop_count, warmup_loop_count);
+        }
+        else
+        {
+            // minmaxloc: a unique minimum 1 and maximum 3 at a third and two thirds
+            // of the vector, written by the locality which holds them
+            std::uint64_t const total = static_cast<std::uint64_t>(size);
+            std::uint64_t const expected_min_index = total / 3;
+            std::uint64_t const expected_max_index = 2 * total / 3;
+            if (kernel == reduction_kernel::minmaxloc)
+            {
+                if (expected_min_index >= view_v.offset() && expected_min_index < view_v.offset() + view_v.size())
+                {
+                    view_v[expected_min_index - view_v.offset()] = 1;
+                }
+                if (expected_max_index >= view_v.offset() && expected_max_index < view_v.offset() + view_v.size())
+                {
+                    view_v[expected_max_index - view_v.offset()] = 3;
+                }
+            }
+        
+            // point-to-point channels between all localities for the all-reduce,
+            // created once outside of the measurement
+            hpx::collectives::channel_communicator allreduce_comm;
+            if (mode != reduction_mode::barrier)
+            {
+                allreduce_comm = hpx::collectives::create_channel_communicator(hpx::launch::sync,
+                    allreduce_channel_name,
+                    hpx::collectives::num_sites_arg(num_localities),
+                    hpx::collectives::this_site_arg(this_locality));
+            }
+        
+            // combine the results of all localities, the global result is
+            // returned on locality 0 (barrier) or on every locality (allreduce)
+            auto combine_localities = [&](auto result, auto op, auto identity,
+                                          auto& per_locality, auto& view_per_locality,
+                                          std::size_t generation) {
+                hpx::chrono::high_resolution_timer t_cluster;
+            
+                if (mode == reduction_mode::allreduce)
+                {
+                    std::vector<hpx::future<void>> pending_sends;
+                    result = all_reduce_localities(allreduce_comm, num_localities, this_locality,
+                        result, op, algorithm, generation, pending_sends);
+                
+                    for (auto& f : pending_sends)
+                    {
+                        f.get();
+                    }
+                    timings.cluster_level += t_cluster.elapsed();
+                    return result;
+                }
+            
+                view_per_locality[0] = result;
+
+                //hpx::cout << "locality: " << hpx::get_locality_id() <<  ", Reduction: " << result << "\n" << std::flush;
+            
+                // Wait for all localities to reach this point.
+                hpx::distributed::barrier::synchronize();
+
+                if (0 == hpx::get_locality_id())
+                {
+                    result = hpx::reduce(hpx::execution::par, per_locality.begin() , per_locality.end(), identity, op);
+                    //hpx::cout << "result: " << result << "\n" << std::flush;
+                }
+                timings.cluster_level += t_cluster.elapsed();
+                return result;
+            };
+        
+            // numa: the slices of the NUMA domains, placed on their domain
+            std::optional<numa_slices<VALUETYPE>> numa_v;
+            if (local == local_reduction::numa)
+            {
+                numa_v.emplace(*hierarchy, view_v);
+            }
+        
+            // reduction of the local part of the vector, flat or over the NUMA
+            // domains. reduce_range(policy, num_workers, first, last, index)
+            // reduces a range with an execution policy on num_workers threads,
+            // index is the local index of first.
+            auto reduce_local = [&](auto identity, auto reduce_range, auto op) {
+                if (numa_v)
+                {
+                    return reduce_numa_domains(*hierarchy, *numa_v,
+                        identity, reduce_range, op, timings);
+                }
+                hpx::chrono::high_resolution_timer t_node;
+                decltype(identity) result = reduce_range(hpx::execution::par,
+                    hpx::get_num_worker_threads(), view_v.begin(), view_v.end(), std::size_t(0));
+                timings.node_level += t_node.elapsed();
+                return result;
+            };
+        
+            // sum with the reducer of a summation mode
+            auto reduce_summation = [&](auto reducer, auto& per_locality, auto& view_per_locality,
+                                        std::size_t generation) {
+                using reducer_type = decltype(reducer);
+                using iterator = partitioned_vector_view<VALUETYPE>::iterator;
+                auto result = reduce_local(reducer_type::identity(),
+                    [&](auto policy, std::size_t num_workers, iterator begin, iterator end, std::size_t) {
+                        return reduce_blocks(policy, num_workers, begin, end, reducer_type::identity(),
+                            [](iterator first, iterator last) { return reducer_type::block(first, last); },
+                            reducer);
+                    },
+                    reducer);
+                return reducer_type::value(combine_localities(result, reducer,
+                    reducer_type::identity(), per_locality, view_per_locality, generation));
+            };
+        
+            // async mode: latency of every reduction of the measured rounds
+            std::vector<double> latencies;
+        
+            // M reductions of the slices in flight, returns the sum of their
+            // global results. Every slice uses its own all-reduce generation.
+            auto async_round = [&](std::size_t generation) -> VALUETYPE {
+                std::size_t const count = view_v.size();
+                std::vector<double> round_latencies(num_in_flight);
+                std::vector<hpx::future<VALUETYPE>> reductions;
+                reductions.reserve(num_in_flight);
+            
+                for (std::size_t k = 0; k != num_in_flight; ++k)
+                {
+                    std::uint64_t const launched = hpx::chrono::high_resolution_clock::now();
+                    std::size_t const slice_generation = (generation - 1) * num_in_flight + k + 1;
+                
+                    reductions.push_back(hpx::reduce(hpx::execution::par(hpx::execution::task),
+                        view_v.begin() + count * k / num_in_flight,
+                        view_v.begin() + count * (k + 1) / num_in_flight,
+                        VALUETYPE(0), std::plus<VALUETYPE>())
+                        .then([&, k, launched, slice_generation](hpx::future<VALUETYPE> local_sum) {
+                            std::vector<hpx::future<void>> pending_sends;
+                            VALUETYPE result = all_reduce_localities(allreduce_comm, num_localities,
+                                this_locality, local_sum.get(), std::plus<VALUETYPE>(), algorithm,
+                                slice_generation, pending_sends);
+                            round_latencies[k] =
+                                (hpx::chrono::high_resolution_clock::now() - launched) * 1e-9;
+                        
+                            for (auto& f : pending_sends)
+                            {
+                                f.get();
+                            }
+                            return result;
+                        }));
+                }
+                hpx::wait_all(reductions);
+            
+                latencies.insert(latencies.end(), round_latencies.begin(), round_latencies.end());
+                VALUETYPE result = 0;
+                for (auto& f : reductions)
+                {
+                    result += f.get();
+                }
+                return result;
+            };
+        
+            // result of the minmaxloc kernel
+            extremum_location extrema = extremum_location::identity();
+        
+            // returns the sum (valid on locality 0 in barrier mode)
+            auto reduction_round = [&](std::size_t generation) -> VALUETYPE {
+                if (mode == reduction_mode::async)
+                {
+                    return async_round(generation);
+                }
+            
+                if (kernel == reduction_kernel::minmaxloc)
+                {
+                    using iterator = partitioned_vector_view<VALUETYPE>::iterator;
+                    std::uint64_t const offset = view_v.offset();
+                    extremum_location result = reduce_local(extremum_location::identity(),
+                        [&](auto policy, std::size_t num_workers, iterator begin, iterator end,
+                            std::size_t index) {
+                            return reduce_blocks(policy, num_workers, begin, end, extremum_location::identity(),
+                                [&, begin, index](iterator first, iterator last) {
+                                    return block_extrema(first, last, offset + index + (first - begin));
+                                },
+                                extremum_combine());
+                        },
+                        extremum_combine());
+                    extrema = combine_localities(result, extremum_combine(), extremum_location::identity(),
+                        extrema_per_locality, *view_extrema, generation);
+                    return extrema.min;
+                }
+            
+                if (kernel == reduction_kernel::statistics)
+                {
+                    using iterator = partitioned_vector_view<VALUETYPE>::iterator;
+                    statistics result = reduce_local(statistics::identity(),
+                        [](auto policy, std::size_t num_workers, iterator begin, iterator end, std::size_t) {
+                            return reduce_blocks(policy, num_workers, begin, end, statistics::identity(),
+                                [](iterator first, iterator last) { return block_statistics(first, last); },
+                                statistics_combine());
+                        },
+                        statistics_combine());
+                    return combine_localities(result, statistics_combine(), statistics::identity(),
+                        statistics_per_locality, *view_statistics, generation).sum;
+                }
+            
+                switch (summation)
+                {
+                case summation_mode::compensated:
+                    return reduce_summation(compensated_reducer(), compensated_sums_per_locality,
+                        *view_compensated_sums, generation);
+                case summation_mode::pairwise:
+                    return reduce_summation(pairwise_reducer(), sums_per_locality, view_sums, generation);
+                case summation_mode::reproducible:
+                    return reduce_summation(reproducible_reducer(), binned_sums_per_locality,
+                        *view_binned_sums, generation);
+                case summation_mode::plain:
+                default:
+                    break;
+                }
+            
+                VALUETYPE result = reduce_local(VALUETYPE(0),
+                    [](auto policy, std::size_t, auto begin, auto end, std::size_t) {
+                        return hpx::reduce(policy, begin, end, VALUETYPE(0), std::plus<VALUETYPE>());
+                    },
+                    std::plus<VALUETYPE>());
+                return combine_localities(result, std::plus<VALUETYPE>(), VALUETYPE(0),
+                    sums_per_locality, view_sums, generation);
+            };
+        
+            std::size_t generation = 0;
+        
+            for (int round = 1; round <= warmup_loop_count; ++round) {
+                reduction_round(++generation);
+            }
+            timings = level_timings(timings.domains.size());
+            latencies.clear();
+        
+            //start timer
+            hpx::chrono::high_resolution_timer t;
+        
+            VALUETYPE result = 0;
+            for (int round = 1; round <= loop_count; ++round) {
+                result = reduction_round(++generation);
+            }
+        
+            //end timer
+            double elapsed = t.elapsed() / loop_count;
+            hpx::util::format_to(std::cout,
+                    "Elapsed Time == {1} [s]\n",
+                    elapsed);
+            hpx::util::format_to(std::cout,
+                    "Bandwidth == {1} [GB/s]\n",
+                    size * sizeof(VALUETYPE) / elapsed / 1e9);
+            hpx::util::format_to(std::cout,
+                    "Element Rate == {1} [Gelements/s]\n",
+                    size / elapsed / 1e9);
+        
+            // async mode: aggregate throughput and latency percentiles
+            if (mode == reduction_mode::async)
+            {
+                std::sort(latencies.begin(), latencies.end());
+                hpx::util::format_to(std::cout,
+                        "Locality {1} Reductions:\n"
+                        "Reduction Throughput == {2} [reductions/s]\n"
+                        "Latency p50 == {3} [s]\n"
+                        "Latency p90 == {4} [s]\n"
+                        "Latency p99 == {5} [s]\n"
+                        "Latency max == {6} [s]\n",
+                        this_locality, num_in_flight / elapsed,
+                        percentile(latencies, 0.5), percentile(latencies, 0.9),
+                        percentile(latencies, 0.99), percentile(latencies, 1.0));
+            }
+        
+            // time per round of every level, one block per locality
+            if (mode != reduction_mode::async)
+            {
+                std::string levels = hpx::util::format(
+                        "Locality {1} Levels:\n", this_locality);
+                for (std::size_t d = 0; d != timings.domains.size(); ++d)
+                {
+                    levels += hpx::util::format(
+                            "NUMA Domain {1} Time == {2} [s]\n", d, timings.domains[d] / loop_count);
+                }
+                if (hierarchy)
+                {
+                    levels += hpx::util::format(
+                            "Domain Level Time == {1} [s]\n", timings.domain_level / loop_count);
+                }
+                levels += hpx::util::format(
+                        "Node Level Time == {1} [s]\n", timings.node_level / loop_count);
+                levels += hpx::util::format(
+                        "Cluster Level Time == {1} [s]\n", timings.cluster_level / loop_count);
+                std::cout << levels << std::flush;
+            }
+        
+            if (kernel == reduction_kernel::minmaxloc)
+            {
+                if (0 == hpx::get_locality_id())
+                {
+                    hpx::util::format_to(std::cout,
+                            "Minimum == {1} at Index {2} (expected 1 at {3})\n"
+                            "Maximum == {4} at Index {5} (expected 3 at {6})\n",
+                            extrema.min, extrema.min_index, expected_min_index,
+                            extrema.max, extrema.max_index, expected_max_index);
+                }
+            }
+            // every element is 2 or a summation value, print the result with all
+            // digits of a float
+            else if (0 == hpx::get_locality_id())
+            {
+                double const expected = mixed_values ?
+                    summation_exact_sum(static_cast<std::uint64_t>(size)) : 2.0 * size;
+                std::cout << "Reduction Result == " << std::setprecision(9) << result << std::endl;
+                hpx::util::format_to(std::cout,
+                        "Relative Error == {1}\n",
+                        std::abs(result - expected) / std::abs(expected));
+            }
+        }
+    }
+         
+    return hpx::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    // add command line option which controls the random number generator seed
+    using namespace hpx::program_options;
+    options_description desc_commandline(
+        "Usage: " HPX_APPLICATION_STRING " [options]");
+
+    desc_commandline.add_options()
+        ("maxelems,m",
+         value<VALUETYPE>()->default_value(1024)
+         ,"size of the vector")
+    
+        ("loop_count"
+        , hpx::program_options::value<int>()->default_value(10)
+        , "number of rounds in performance measurement loop")
+    
+        ("warmup_loop_count"
+        , hpx::program_options::value<int>()->default_value(4)
+        , "number of warmup rounds in cache warmup loop")
+    
+        ("reduction_mode"
+        , hpx::program_options::value<std::string>()->default_value("barrier")
+        , "combination of the sums per locality: barrier, allreduce or async (in_flight reductions at the same time)")
+    
+        ("in_flight"
+        , hpx::program_options::value<std::size_t>()->default_value(1)
+        , "number of reductions in flight at the same time in the async reduction_mode")
+    
+        ("reduction_kernel"
+        , hpx::program_options::value<std::string>()->default_value("sum")
+        , "local reduction: sum, statistics (sum, min, max, sum of squares and count in one pass), rows (sums of short rows, batched vs hpx::reduce per row), minmaxloc (minimum and maximum with their global indices), by_key (reduce-by-key over sorted keys) or histogram (counts per bin, merged with the all-reduce)")
+    
+        ("row_length"
+        , hpx::program_options::value<std::size_t>()->default_value(0)
+        , "row length of the rows kernel in elements, 0 sweeps 256 to 16384 (1 to 64 KiB)")
+    
+        ("run_length_distribution"
+        , hpx::program_options::value<std::string>()->default_value("geometric")
+        , "run lengths of the keys of the by_key kernel: constant, geometric or mixed")
+    
+        ("mean_run_length"
+        , hpx::program_options::value<std::uint64_t>()->default_value(16)
+        , "mean run length of the keys of the by_key kernel")
+    
+        ("histogram_method"
+        , hpx::program_options::value<std::string>()->default_value("atomic")
+        , "bins of the histogram kernel: atomic (shared), privatized (per worker thread) or numa (per NUMA domain)")
+    
+        ("num_bins"
+        , hpx::program_options::value<std::size_t>()->default_value(0)
+        , "number of bins of the histogram kernel, 0 sweeps 16 to 2^20")
+    
+        ("bin_skew"
+        , hpx::program_options::value<double>()->default_value(0)
+        , "fraction of the values of the histogram kernel in bin 0, the others are uniform")
+    
+        ("storage"
+        , hpx::program_options::value<std::string>()->default_value("float")
+        , "storage type of the vector for the plain sum: float, bf16, fp16, int16 or int8 (scaled), or the 32 bit integers uint32, bitpacked or delta_for (compressed)")
+    
+        ("compressed_bits"
+        , hpx::program_options::value<int>()->default_value(0)
+        , "bits per entry of the bitpacked and delta_for storage: 4, 8, 12, 16 or 24, 0 sweeps all of them")
+    
+        ("accumulate"
+        , hpx::program_options::value<std::string>()->default_value("float")
+        , "accumulation type of the plain sum over the storage type: float or double")
+    
+        ("summation"
+        , hpx::program_options::value<std::string>()->default_value("plain")
+        , "summation of the sum kernel: plain, compensated, pairwise or reproducible")
+    
+        ("allreduce_algorithm"
+        , hpx::program_options::value<std::string>()->default_value("tree")
+        , "all-reduce between the localities: tree, recursive_doubling or ring")
+    
+        ("local_reduction"
+        , hpx::program_options::value<std::string>()->default_value("flat")
+        , "reduction inside a locality: flat or numa (per NUMA domain on its own cores, then across the domains)")
         ;
 
     // run hpx_main on all localities
@@ -4,21 +4,66 @@
 #include <hpx/hpx.hpp>
 #include <hpx/hpx_init.hpp>
 #include <hpx/include/partitioned_vector.hpp>
+#include <hpx/modules/collectives.hpp>
 #include <hpx/modules/program_options.hpp>
+#include <hpx/serialization/vector.hpp>
+#include <hpx/unwrap.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <ctime>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <optional>
 #include <random>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
+#include <unistd.h>
 #include <hpx/iostream.hpp>
  
 ///////////////////////////////////////////////////////////////////////////////
 using VALUETYPE = float;
+// segment head flags of the segmented scan
+using FLAGTYPE = std::uint8_t;
+
+// element types of the operator benchmarks (see the scan operators below)
+struct affine_map
+{
+    // x -> a * x + b
+    VALUETYPE a;
+    VALUETYPE b;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int)
+    {
+        ar & a & b;
+    }
+};
+
+struct count_sum
+{
+    std::uint64_t count;
+    VALUETYPE sum;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int)
+    {
+        ar & count & sum;
+    }
+};
 
 // Define the vector types to be used.
 HPX_REGISTER_PARTITIONED_VECTOR(VALUETYPE)
+HPX_REGISTER_PARTITIONED_VECTOR(FLAGTYPE)
+HPX_REGISTER_PARTITIONED_VECTOR(affine_map)
+HPX_REGISTER_PARTITIONED_VECTOR(count_sum)
  
 hpx::init_params init_args;
 ///////////////////////////////////////////////////////////////////////////////
@@ -89,160 +134,1551 @@ private:
     local_segment_iterator segment_iterator_;
 };
 ///////////////////////////////////////////////////////////////////////////////
-int hpx_main(hpx::program_options::variables_map& vm)
+//
+// Scan operators.
+//
+// An operator defines value_type, an associative operator() and the value
+// the benchmark fills element i with (sample). Operators with an identity
+// provide identity(), which enables the fast path of the scan engine. Only
+// commutative operators may be reduced with hpx::reduce, all others are
+// reduced strictly in order.
+//
+template <typename T>
+struct plus_op
 {
-    VALUETYPE size = vm["maxelems"].as<VALUETYPE>();
-    int loop_count = vm["loop_count"].as<int>();
-    int warmup_loop_count = vm["warmup_loop_count"].as<int>();
-    
-    //print vector size
-    if (0 == hpx::get_locality_id())
+    using value_type = T;
+    static constexpr bool commutative = true;
+
+    T operator()(T const& a, T const& b) const
     {
-        std::cout << "Scan Vector Size: " << size << std::endl;
+        return a + b;
     }
-    
-    char const* const vector_name_1 =
-        "partitioned_vector_1";
-    char const* const vector_name_2 =
-        "partitioned_vector_2";
-    
+    static T identity()
     {
-        // create vector on one locality, connect to it from all others
-        hpx::partitioned_vector<VALUETYPE> main_vector;
-        hpx::partitioned_vector<VALUETYPE> sums_per_locality;
-        
-        if (0 == hpx::get_locality_id())
+        return T(0);
+    }
+    static T sample(std::size_t)
+    {
+        return T(2);
+    }
+};
+
+template <typename T>
+struct max_op
+{
+    using value_type = T;
+    static constexpr bool commutative = true;
+
+    T operator()(T const& a, T const& b) const
+    {
+        return (std::max)(a, b);
+    }
+    static T identity()
+    {
+        return std::numeric_limits<T>::lowest();
+    }
+    static T sample(std::size_t i)
+    {
+        // cheap hash, so the running maximum keeps changing
+        return T((i * 2654435761u) % 1024);
+    }
+};
+
+// Composition of affine maps, (f, g) -> g(f(x)). Scanning a sequence of
+// maps gives the map from the start of the sequence to every position, the
+// building block of linear recurrences x[i] = a[i] * x[i-1] + b[i].
+struct affine_compose
+{
+    using value_type = affine_map;
+    static constexpr bool commutative = false;
+
+    affine_map operator()(affine_map const& f, affine_map const& g) const
+    {
+        return affine_map{g.a * f.a, g.a * f.b + g.b};
+    }
+    static affine_map identity()
+    {
+        return affine_map{1, 0};
+    }
+    static affine_map sample(std::size_t)
+    {
+        return affine_map{1, 1};
+    }
+};
+
+struct count_sum_plus
+{
+    using value_type = count_sum;
+    static constexpr bool commutative = true;
+
+    count_sum operator()(count_sum const& a, count_sum const& b) const
+    {
+        return count_sum{a.count + b.count, a.sum + b.sum};
+    }
+    static count_sum identity()
+    {
+        return count_sum{0, 0};
+    }
+    static count_sum sample(std::size_t)
+    {
+        return count_sum{1, 2};
+    }
+};
+
+template <typename Op, typename = void>
+struct has_identity : std::false_type
+{
+};
+
+template <typename Op>
+struct has_identity<Op, std::void_t<decltype(Op::identity())>> : std::true_type
+{
+};
+
+// A value which may be missing, used to exchange the carry-in of operators
+// without identity: locality 0 has no carry-in at all.
+template <typename T>
+struct optional_value
+{
+    T value;
+    bool valid;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int)
+    {
+        ar & value & valid;
+    }
+};
+
+// the missing value acts as identity of the lifted operator
+template <typename Op>
+struct optional_op
+{
+    Op op;
+
+    template <typename T>
+    optional_value<T> operator()(optional_value<T> const& a, optional_value<T> const& b) const
+    {
+        if (!a.valid)
         {
-            std::vector<hpx::id_type> localities = hpx::find_all_localities();
-            
-            main_vector = hpx::partitioned_vector<VALUETYPE>(size, hpx::container_layout(localities));
-            main_vector.register_as(vector_name_1);
- 
-            sums_per_locality = hpx::partitioned_vector<VALUETYPE>(localities.size(), hpx::container_layout(localities));
-            sums_per_locality.register_as(vector_name_2);
+            return b;
         }
-        else
+        if (!b.valid)
         {
-            hpx::future<void> f1 = main_vector.connect_to(vector_name_1);
-            hpx::future<void> f2 = sums_per_locality.connect_to(vector_name_2);
-            f1.get();
-            f2.get();
+            return a;
         }
- 
-        // fill the partitioned vector main_vector with numbers 2 per locality
-        partitioned_vector_view<VALUETYPE> main_vector_view(main_vector);
-        hpx::generate(hpx::execution::par, main_vector_view.begin(), main_vector_view.end(),
-                      [&]() { return 2; });
-        
-        // Situation example (main_vector):
-        // 3 Localities (Lx) and a vector size of 15:
-        // L0 main_vector_view(5) 2 2 2 2 2
-        // L1 main_vector_view(5)           2 2 2 2 2
-        // L2 main_vector_view(5)                     2 2 2 2 2
-        // main_vector:           2 2 2 2 2 2 2 2 2 2 2 2 2 2 2
-        
-        partitioned_vector_view<VALUETYPE> sums_per_locality_view(sums_per_locality);
-        
-        // warm-up cache
-        for (int round = 1; round <= warmup_loop_count; ++round) {
-            // reduce per locality the main_vector entries and save it via sums_per_locality_view:
-            VALUETYPE result = hpx::reduce(hpx::execution::par, main_vector_view.begin() , main_vector_view.end());
-            sums_per_locality_view[0] = result;
-            
-            // Situation example (sums_per_locality):
-            // 3 Localities (Lx):
-            // L0 sums_per_locality_view[0]        10
-            // L1 sums_per_locality_view[0]           10
-            // L2 sums_per_locality_view[0]              10
-            // sums_per_locality:                  10 10 10
-            
-            // Wait for all localities to reach this point.
-            hpx::distributed::barrier::synchronize();
-        
-            if (0 == hpx::get_locality_id())
+        return optional_value<T>{op(a.value, b.value), true};
+    }
+
+    template <typename T>
+    std::optional<T> operator()(std::optional<T> const& a, std::optional<T> const& b) const
+    {
+        if (!a)
+        {
+            return b;
+        }
+        if (!b)
+        {
+            return a;
+        }
+        return op(*a, *b);
+    }
+};
+///////////////////////////////////////////////////////////////////////////////
+//
+// Exclusive scan of one value per locality (the carry-in of every locality).
+//
+// Every locality contributes the sum of its own segment and gets back the
+// combined sums of all localities with a lower id. The values are exchanged
+// point-to-point over a channel_communicator, so no global barrier and no
+// remote partitioned_vector access is involved.
+//
+// Situation example (3 Localities, local sums 10 10 10):
+// L0 carry 0
+// L1 carry    10
+// L2 carry       20
+//
+enum class carry_algorithm
+{
+    linear,                // chain L0 -> L1 -> ... -> Ln-1, n-1 hops
+    recursive_doubling,    // Hillis-Steele over localities, log2(n) rounds
+    tree                   // binomial up-sweep and down-sweep, 2*log2(n) hops
+};
+
+carry_algorithm parse_carry_algorithm(std::string const& name)
+{
+    if (name == "linear")
+        return carry_algorithm::linear;
+    if (name == "recursive_doubling")
+        return carry_algorithm::recursive_doubling;
+    if (name == "tree")
+        return carry_algorithm::tree;
+    throw std::invalid_argument("unknown carry_algorithm: " + name);
+}
+
+// Every scan round gets its own range of channel tags, so messages of
+// consecutive rounds can never be mixed up. The down-sweep of the tree uses
+// the upper half of the range.
+constexpr std::size_t carry_tags_per_round = 128;
+constexpr std::size_t carry_down_sweep_tag = 64;
+
+inline hpx::collectives::tag_arg carry_tag(std::size_t generation, std::size_t step)
+{
+    return hpx::collectives::tag_arg(generation * carry_tags_per_round + step);
+}
+
+// The returned value is the carry-in of this locality. Outgoing messages are
+// appended to pending_sends and have to be waited for by the caller; they are
+// not waited for here so they never sit on the critical path of the caller.
+template <typename T, typename Op>
+T exclusive_scan_localities(hpx::collectives::channel_communicator comm,
+    std::size_t num_localities, std::size_t this_locality, T const& local,
+    T const& identity, Op&& op, carry_algorithm algorithm,
+    std::size_t generation, std::vector<hpx::future<void>>& pending_sends)
+{
+    using hpx::collectives::get;
+    using hpx::collectives::set;
+    using hpx::collectives::that_site_arg;
+
+    T carry = identity;
+
+    switch (algorithm)
+    {
+    case carry_algorithm::linear:
+    {
+        if (this_locality != 0)
+        {
+            carry = get<T>(comm, that_site_arg(this_locality - 1),
+                carry_tag(generation, 0)).get();
+        }
+        if (this_locality + 1 != num_localities)
+        {
+            pending_sends.push_back(set(comm, that_site_arg(this_locality + 1),
+                T(op(carry, local)), carry_tag(generation, 0)));
+        }
+        break;
+    }
+
+    case carry_algorithm::recursive_doubling:
+    {
+        // after round k, inclusive holds the combined values of
+        // [this_locality - 2^(k+1) + 1, this_locality]
+        T inclusive = local;
+        std::size_t step = 0;
+        for (std::size_t d = 1; d < num_localities; d <<= 1, ++step)
+        {
+            if (this_locality + d < num_localities)
             {
-                //sums_per_locality: 10 10 10 --> has to be changed to 10 20 30 via inclusive_scan (locality 0 has access to the whole vector):
-                hpx::inclusive_scan(hpx::execution::par, sums_per_locality.begin(), sums_per_locality.end(), sums_per_locality.begin());
-                
-                //now we have to shift_right the transformed sums_per_locality --> from 10 20 30 to 10 10 20:
-                for (VALUETYPE i = sums_per_locality.size()-1; i != 0; --i)
-                {
-                     VALUETYPE x = sums_per_locality[i-1];
-                     sums_per_locality[i] = x;
-                }
-                // finally change it from 10 10 20 to 0 10 20:
-                sums_per_locality[0] = 0;
+                pending_sends.push_back(set(comm, that_site_arg(this_locality + d),
+                    T(inclusive), carry_tag(generation, step)));
+            }
+            if (this_locality >= d)
+            {
+                T received = get<T>(comm, that_site_arg(this_locality - d),
+                    carry_tag(generation, step)).get();
+                carry = op(received, carry);
+                inclusive = op(received, inclusive);
             }
-            
-            // Wait for all localities to reach this point.
-            hpx::distributed::barrier::synchronize();
-            
-            // make the final inclusive_scan on the main_vector_view and start with the respective value from sums_per_locality via the sums_per_locality_view:
-            hpx::inclusive_scan(hpx::execution::par, main_vector_view.begin(), main_vector_view.end(), main_vector_view.begin(), std::plus<VALUETYPE>(), sums_per_locality_view[0]);
-            
+        }
+        break;
+    }
+
+    case carry_algorithm::tree:
+    {
+        // up-sweep: the locality is the root of the subtree
+        // [this_locality, this_locality + 2^k) for every k below its level,
+        // partials[k] holds the combined values of that subtree
+        std::vector<T> partials;
+        T total = local;
+        std::size_t level = 0;
+        std::size_t d = 1;
+        for (; d < num_localities; d <<= 1, ++level)
+        {
+            if (this_locality % (2 * d) != 0)
+            {
+                // hand the total of the own subtree to the parent
+                pending_sends.push_back(set(comm, that_site_arg(this_locality - d),
+                    T(total), carry_tag(generation, level)));
+                break;
             }
-        
-        //start timer
-        hpx::chrono::high_resolution_timer t;
-        for (int round = 1; round <= loop_count; ++round) {
-            VALUETYPE result = hpx::reduce(hpx::execution::par, main_vector_view.begin() , main_vector_view.end());
-            sums_per_locality_view[0] = result;
-            
-            // Wait for all localities to reach this point.
-            hpx::distributed::barrier::synchronize();
-        
-            if (0 == hpx::get_locality_id())
+            partials.push_back(total);
+            if (this_locality + d < num_localities)
             {
-                hpx::inclusive_scan(hpx::execution::par, sums_per_locality.begin(), sums_per_locality.end(), sums_per_locality.begin());
-                
-                for (VALUETYPE i = sums_per_locality.size()-1; i != 0; --i)
-                {
-                     VALUETYPE x = sums_per_locality[i-1];
-                     sums_per_locality[i] = x;
-                }
-                
-                sums_per_locality[0] = 0;
+                total = op(total, get<T>(comm, that_site_arg(this_locality + d),
+                    carry_tag(generation, level)).get());
             }
-            
-            // Wait for all localities to reach this point.
-            hpx::distributed::barrier::synchronize();
-            
-            hpx::inclusive_scan(hpx::execution::par, main_vector_view.begin(), main_vector_view.end(), main_vector_view.begin(), std::plus<VALUETYPE>(), sums_per_locality_view[0]);
-            
+        }
+
+        // down-sweep: receive the carry from the parent and pass the carry of
+        // every child on (the largest subtree first)
+        if (this_locality != 0)
+        {
+            carry = get<T>(comm, that_site_arg(this_locality - d),
+                carry_tag(generation, carry_down_sweep_tag + level)).get();
+        }
+        for (std::size_t k = partials.size(); k-- != 0;)
+        {
+            std::size_t child = this_locality + (std::size_t(1) << k);
+            if (child < num_localities)
+            {
+                pending_sends.push_back(set(comm, that_site_arg(child),
+                    T(op(carry, partials[k])),
+                    carry_tag(generation, carry_down_sweep_tag + k)));
             }
-        //end timer
-        double elapsed = t.elapsed() / loop_count;
-        hpx::util::format_to(std::cout,
-                "Elapsed Time == {1} [s]\n",
-                elapsed);
- 
-        // Wait for all localities to reach this point.
-        hpx::distributed::barrier::synchronize();
-         
+        }
+        break;
     }
-         
-    return hpx::finalize();
+    }
+
+    return carry;
 }
- 
-int main(int argc, char* argv[])
+///////////////////////////////////////////////////////////////////////////////
+//
+// Local scan kernels.
+//
+// two_pass: hpx::reduce followed by hpx::inclusive_scan over the whole
+//           segment, the segment is streamed from memory for every pass.
+// lookback: single-pass chunked scan with decoupled look-back. Every chunk is
+//           reduced and then scanned while it is still in cache, the prefix of
+//           a chunk is taken from the status of its predecessors, so the scan
+//           reads the segment from memory once and writes it once. The carry-in
+//           of a locality needs the sums of the localities in front of it
+//           before the scan starts, so every locality except the last still
+//           reduces its segment in a pass of its own (see needs_local_sum).
+//           Single-pass holds on one locality and for the last one only.
+// tiled:    reduce-then-scan over tiles of one L2-sized block per worker
+//           thread. The blocks of a tile are reduced in parallel, combined
+//           in order with the carry of the previous tiles and scanned in
+//           parallel while they are still in cache.
+//
+// All kernels take the prefix of the range as std::optional. Without a
+// prefix (locality 0 of an operator without identity) the first element
+// starts the scan, an exclusive scan leaves it unchanged.
+//
+enum class local_scan_variant
 {
-    // add command line option which controls the random number generator seed
-    using namespace hpx::program_options;
-    options_description desc_commandline(
-        "Usage: " HPX_APPLICATION_STRING " [options]");
- 
-    desc_commandline.add_options()
-        ("maxelems,m",
-         value<VALUETYPE>()->default_value(1024)
-         ,"size of the vector")
-    
-        ("loop_count"
-        , hpx::program_options::value<int>()->default_value(10)
-        , "number of rounds in performance measurement loop")
-    
-        ("warmup_loop_count"
-        , hpx::program_options::value<int>()->default_value(4)
-        , "number of warmup rounds in cache warmup loop")
+    two_pass,
+    lookback,
+    tiled
+};
+
+local_scan_variant parse_local_scan_variant(std::string const& name)
+{
+    if (name == "two_pass")
+        return local_scan_variant::two_pass;
+    if (name == "lookback")
+        return local_scan_variant::lookback;
+    if (name == "tiled")
+        return local_scan_variant::tiled;
+    throw std::invalid_argument("unknown local_scan: " + name);
+}
+
+enum class scan_type
+{
+    inclusive,
+    exclusive
+};
+
+scan_type parse_scan_type(std::string const& name)
+{
+    if (name == "inclusive")
+        return scan_type::inclusive;
+    if (name == "exclusive")
+        return scan_type::exclusive;
+    throw std::invalid_argument("unknown scan_type: " + name);
+}
+
+// Sequential scan of [first, last) into dest continuing from prefix.
+template <typename Iter, typename OutIter, typename T, typename Op>
+void scan_chunk(Iter first, Iter last, OutIter dest, std::optional<T> const& prefix,
+    Op const& op, scan_type type)
+{
+    if (first == last)
+    {
+        return;
+    }
+
+    T running;
+    if (prefix)
+    {
+        running = *prefix;
+    }
+    else
+    {
+        running = *first;
+        *dest = running;
+        ++first;
+        ++dest;
+    }
+
+    if (type == scan_type::inclusive)
+    {
+        for (; first != last; ++first, ++dest)
+        {
+            running = op(running, *first);
+            *dest = running;
+        }
+    }
+    else
+    {
+        for (; first != last; ++first, ++dest)
+        {
+            T value = *first;
+            *dest = running;
+            running = op(running, value);
+        }
+    }
+}
+
+// Sequential sum of [first, last), std::nullopt for an empty range.
+template <typename Iter, typename Op>
+std::optional<typename Op::value_type> sequential_reduce(Iter first, Iter last, Op const& op)
+{
+    using T = typename Op::value_type;
+
+    if (first == last)
+    {
+        return std::nullopt;
+    }
+    T sum = *first;
+    for (++first; first != last; ++first)
+    {
+        sum = op(sum, *first);
+    }
+    return sum;
+}
+
+// Sum of [first, last), std::nullopt for an empty range without identity.
+// hpx::reduce may combine the partial sums in any order, so it is only used
+// for commutative operators, all others are reduced in order chunk by chunk.
+template <bool UseIdentity, typename Iter, typename Op>
+std::optional<typename Op::value_type> reduce_range(Iter first, Iter last, Op const& op)
+{
+    using T = typename Op::value_type;
+
+    if constexpr (UseIdentity && Op::commutative)
+    {
+        return hpx::reduce(hpx::execution::par, first, last, Op::identity(), op);
+    }
+    else
+    {
+        std::size_t const count = std::distance(first, last);
+        if (count == 0)
+        {
+            if constexpr (UseIdentity)
+            {
+                return Op::identity();
+            }
+            return std::nullopt;
+        }
+
+        std::size_t const num_chunks =
+            (std::min)(count, std::size_t(4 * hpx::get_num_worker_threads()));
+        std::size_t const chunk_size = (count + num_chunks - 1) / num_chunks;
+        std::vector<std::optional<T>> partials(num_chunks);
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_chunks,
+            [&](std::size_t k) {
+                std::size_t const begin = (std::min)(k * chunk_size, count);
+                std::size_t const end = (std::min)(begin + chunk_size, count);
+                partials[k] = sequential_reduce(first + begin, first + end, op);
+            });
+
+        optional_op<Op> lifted{op};
+        std::optional<T> total;
+        for (auto const& partial : partials)
+        {
+            total = lifted(total, partial);
+        }
+        return total;
+    }
+}
+
+template <typename Iter, typename OutIter, typename T, typename Op>
+void two_pass_scan(Iter first, Iter last, OutIter dest, std::optional<T> const& init,
+    Op const& op, scan_type type)
+{
+    if (first == last)
+    {
+        return;
+    }
+
+    if (!init)
+    {
+        // the first element starts the scan
+        T first_value = *first;
+        *dest = first_value;
+        if (type == scan_type::inclusive)
+        {
+            hpx::inclusive_scan(hpx::execution::par, std::next(first), last, std::next(dest), op, first_value);
+        }
+        else
+        {
+            hpx::exclusive_scan(hpx::execution::par, std::next(first), last, std::next(dest), first_value, op);
+        }
+        return;
+    }
+
+    if (type == scan_type::inclusive)
+    {
+        hpx::inclusive_scan(hpx::execution::par, first, last, dest, op, *init);
+    }
+    else
+    {
+        hpx::exclusive_scan(hpx::execution::par, first, last, dest, *init, op);
+    }
+}
+
+// Status of one chunk of the decoupled look-back, published with release
+// semantics after the corresponding value has been written.
+enum chunk_flag : int
+{
+    chunk_invalid = 0,
+    chunk_aggregate_available = 1,
+    chunk_prefix_available = 2
+};
+
+template <typename T>
+struct alignas(64) chunk_status
+{
+    std::atomic<int> flag{chunk_invalid};
+    T aggregate;
+    T inclusive_prefix;
+};
+
+// Scan of [first, last) into dest starting with init.
+//
+// Chunks are handed out in ascending order through an atomic counter, so
+// every predecessor a chunk looks back on is already owned by a running
+// task and the look-back always makes progress.
+template <typename Iter, typename OutIter, typename T, typename Op>
+void lookback_scan(Iter first, Iter last, OutIter dest, std::optional<T> const& init,
+    Op const& op, std::size_t chunk_size, scan_type type)
+{
+    std::size_t const count = std::distance(first, last);
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::size_t const num_chunks = (count + chunk_size - 1) / chunk_size;
+    std::vector<chunk_status<T>> status(num_chunks);
+    std::atomic<std::size_t> next_chunk(0);
+
+    auto worker = [&]() {
+        for (std::size_t c = next_chunk++; c < num_chunks; c = next_chunk++)
+        {
+            Iter begin = first + c * chunk_size;
+            Iter end = (c + 1 == num_chunks) ? last : begin + chunk_size;
+            OutIter out = dest + c * chunk_size;
+
+            T aggregate = *begin;
+            for (Iter it = begin + 1; it != end; ++it)
+            {
+                aggregate = op(aggregate, *it);
+            }
+
+            std::optional<T> exclusive = init;
+            if (c == 0)
+            {
+                status[0].inclusive_prefix = init ? op(*init, aggregate) : aggregate;
+                status[0].flag.store(chunk_prefix_available, std::memory_order_release);
+            }
+            else
+            {
+                // publish the aggregate of this chunk for its successors
+                status[c].aggregate = aggregate;
+                status[c].flag.store(chunk_aggregate_available, std::memory_order_release);
+
+                // look back until a predecessor with a known prefix is found
+                std::size_t p = c;
+                int flag = chunk_invalid;
+                T prefix;
+                bool first_predecessor = true;
+                do
+                {
+                    --p;
+                    while ((flag = status[p].flag.load(std::memory_order_acquire)) == chunk_invalid)
+                    {
+                        hpx::this_thread::yield();
+                    }
+                    T const& value = flag == chunk_prefix_available ?
+                        status[p].inclusive_prefix : status[p].aggregate;
+                    prefix = first_predecessor ? value : op(value, prefix);
+                    first_predecessor = false;
+                } while (flag != chunk_prefix_available);
+
+                status[c].inclusive_prefix = op(prefix, aggregate);
+                status[c].flag.store(chunk_prefix_available, std::memory_order_release);
+                exclusive = prefix;
+            }
+
+            // the chunk is still in cache, scan it with its prefix
+            scan_chunk(begin, end, out, exclusive, op, type);
+        }
+    };
+
+    std::size_t const num_workers =
+        (std::min)(std::size_t(hpx::get_num_worker_threads()), num_chunks);
+    std::vector<hpx::future<void>> workers;
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i != num_workers; ++i)
+    {
+        workers.push_back(hpx::async(worker));
+    }
+    hpx::wait_all(workers);
+}
+
+// Size of the L2 cache of the first core in bytes, 512 KiB if it can not be
+// detected.
+std::size_t detect_l2_cache_size()
+{
+    long const size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    return size > 0 ? std::size_t(size) : std::size_t(512) * 1024;
+}
+
+// Number of elements of type T per block of the tiled kernel: half of the L2
+// cache, the other half is left to the rest of the working set.
+template <typename T>
+std::size_t default_tile_size()
+{
+    return (std::max)(std::size_t(1), detect_l2_cache_size() / 2 / sizeof(T));
+}
+
+// Scan of [first, last) into dest starting with init, tile by tile. A tile
+// consists of one block of tile_size elements per worker thread, tile_size 0
+// selects default_tile_size.
+template <typename Iter, typename OutIter, typename T, typename Op>
+void tiled_scan(Iter first, Iter last, OutIter dest, std::optional<T> const& init,
+    Op const& op, std::size_t tile_size, scan_type type)
+{
+    if (tile_size == 0)
+    {
+        tile_size = default_tile_size<T>();
+    }
+
+    std::size_t const count = std::distance(first, last);
+    std::size_t const blocks_per_tile = hpx::get_num_worker_threads();
+    optional_op<Op> lifted{op};
+
+    std::optional<T> carry = init;
+    std::vector<std::optional<T>> prefixes(blocks_per_tile);
+    for (std::size_t tile_begin = 0; tile_begin < count; tile_begin += blocks_per_tile * tile_size)
+    {
+        std::size_t const tile_count = (std::min)(blocks_per_tile * tile_size, count - tile_begin);
+        std::size_t const num_blocks = (tile_count + tile_size - 1) / tile_size;
+        auto block_begin = [&](std::size_t k) {
+            return tile_begin + (std::min)(k * tile_size, tile_count);
+        };
+
+        // bring the tile into cache and reduce its blocks
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_blocks,
+            [&](std::size_t k) {
+                prefixes[k] = sequential_reduce(first + block_begin(k), first + block_begin(k + 1), op);
+            });
+
+        // exclusive prefix of every block, starting with the carry of the previous tiles
+        for (std::size_t k = 0; k != num_blocks; ++k)
+        {
+            std::optional<T> const sum = prefixes[k];
+            prefixes[k] = carry;
+            carry = lifted(carry, sum);
+        }
+
+        // scan the blocks while they are still in cache
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_blocks,
+            [&](std::size_t k) {
+                scan_chunk(first + block_begin(k), first + block_begin(k + 1),
+                    dest + block_begin(k), prefixes[k], op, type);
+            });
+    }
+}
+
+// Dispatch to the local scan kernel selected by variant.
+template <typename Iter, typename OutIter, typename T, typename Op>
+void local_scan(local_scan_variant variant, Iter first, Iter last, OutIter dest,
+    std::optional<T> const& init, Op const& op, std::size_t chunk_size,
+    std::size_t tile_size, scan_type type)
+{
+    switch (variant)
+    {
+    case local_scan_variant::two_pass:
+        two_pass_scan(first, last, dest, init, op, type);
+        break;
+    case local_scan_variant::lookback:
+        lookback_scan(first, last, dest, init, op, chunk_size, type);
+        break;
+    case local_scan_variant::tiled:
+    default:
+        tiled_scan(first, last, dest, init, op, tile_size, type);
+        break;
+    }
+}
+///////////////////////////////////////////////////////////////////////////////
+//
+// Scan modes.
+//
+// bulk:      reduce the segment, exchange the carry-in, scan the segment, every
+//            step finishes on the locality before the next one starts.
+// pipelined: the segment is split into chunks which are reduced by
+//            independent tasks. The prefix of every chunk is a future chained
+//            from the carry-in of the locality and the sums of the chunks in
+//            front of it, and the chunk is scanned as soon as that future is
+//            ready. The carry-in is exchanged as soon as the last chunk sum is
+//            known, so a locality scans while its successors are still
+//            waiting for their carry and nothing waits for a global step.
+// segmented: scan of many back to back segments, a companion flag vector
+//            marks the head of every segment and the prefix restarts there.
+// batched:   scan of many independent vectors (the logical rows of one
+//            vector). The sums of all rows are exchanged in one collective
+//            round and the rows are scanned concurrently. The other modes
+//            scan the rows one after another, one round per row.
+//
+enum class scan_mode
+{
+    bulk,
+    pipelined,
+    segmented,
+    batched
+};
+
+scan_mode parse_scan_mode(std::string const& name)
+{
+    if (name == "bulk")
+        return scan_mode::bulk;
+    if (name == "pipelined")
+        return scan_mode::pipelined;
+    if (name == "segmented")
+        return scan_mode::segmented;
+    if (name == "batched")
+        return scan_mode::batched;
+    throw std::invalid_argument("unknown scan_mode: " + name);
+}
+
+// Scan of [first, last) into dest split into num_chunks chunks.
+// exchange_carry is called with the sum of the whole range and returns the
+// carry-in of the range, it runs on its own task. Sums and prefixes are
+// std::optional, a missing value acts as identity (see optional_op).
+template <typename Iter, typename OutIter, typename Op, typename ExchangeCarry>
+void pipelined_scan(Iter first, Iter last, OutIter dest, std::size_t num_chunks,
+    Op const& op, scan_type type, ExchangeCarry&& exchange_carry)
+{
+    using T = typename Op::value_type;
+    using prefix_type = std::optional<T>;
+    optional_op<Op> lifted{op};
+
+    std::size_t const count = std::distance(first, last);
+    num_chunks = (std::max)(std::size_t(1), (std::min)(num_chunks, count));
+    std::size_t const chunk_size = (count + num_chunks - 1) / num_chunks;
+    if (chunk_size != 0)
+    {
+        num_chunks = (count + chunk_size - 1) / chunk_size;
+    }
+
+    // prefixes[k] is the sum of all chunks in front of chunk k,
+    // prefixes[num_chunks] the sum of the whole range
+    std::vector<hpx::shared_future<prefix_type>> prefixes;
+    prefixes.reserve(num_chunks + 1);
+    prefixes.push_back(hpx::make_ready_future(prefix_type()).share());
+    for (std::size_t k = 0; k != num_chunks; ++k)
+    {
+        Iter begin = first + (std::min)(k * chunk_size, count);
+        Iter end = first + (std::min)((k + 1) * chunk_size, count);
+        hpx::future<prefix_type> chunk_sum = hpx::async([=]() {
+            return sequential_reduce(begin, end, op);
+        });
+        prefixes.push_back(hpx::dataflow(hpx::unwrapping(lifted),
+            prefixes.back(), std::move(chunk_sum)).share());
+    }
+
+    hpx::shared_future<prefix_type> carry = prefixes.back().then(
+        [&](hpx::shared_future<prefix_type> total) { return exchange_carry(total.get()); })
+                                                .share();
+
+    std::vector<hpx::future<void>> chunk_scans;
+    chunk_scans.reserve(num_chunks);
+    for (std::size_t k = 0; k != num_chunks; ++k)
+    {
+        Iter begin = first + (std::min)(k * chunk_size, count);
+        Iter end = first + (std::min)((k + 1) * chunk_size, count);
+        OutIter out = dest + (std::min)(k * chunk_size, count);
+        chunk_scans.push_back(hpx::dataflow(
+            hpx::unwrapping([=](prefix_type const& carry_in, prefix_type const& prefix) {
+                scan_chunk(begin, end, out, lifted(carry_in, prefix), op, type);
+            }),
+            carry, prefixes[k]));
+    }
+    hpx::wait_all(chunk_scans);
+    carry.get();
+}
+///////////////////////////////////////////////////////////////////////////////
+//
+// Segmented scan.
+//
+// Every element is paired with its head flag and the pairs are combined with
+//   (a, fa) + (b, fb) = fb ? (b, 1) : (a + b, fa)
+// which is associative, so the same carry-in exchange as for the plain scan
+// carries a running segment across locality boundaries: a locality without
+// any head in front of an element passes the sum of the open segment on.
+//
+// Situation example (3 Localities, segment heads marked with *):
+// L0 values 2 2 *2 2           -> 2 4 2 4
+// L1 values 2 2  2 *2          -> 6 8 10 2
+// L2 values 2 2 *2 2           -> 4 6 2 4
+// L1 gets the carry (4, 1) from L0, L2 gets (2, 1) from L0 and L1 together.
+//
+template <typename T>
+struct segmented_value
+{
+    T value;
+    FLAGTYPE head;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int)
+    {
+        ar & value & head;
+    }
+};
+
+template <typename T>
+struct segmented_plus
+{
+    segmented_value<T> operator()(segmented_value<T> const& a,
+        segmented_value<T> const& b) const
+    {
+        if (b.head)
+        {
+            return b;
+        }
+        return segmented_value<T>{a.value + b.value, a.head};
+    }
+};
+
+// Segment-length distributions used to place the segment heads:
+// short:  uniform in [1, 32] elements
+// long:   uniform in [2^16, 2^18] elements, segments straddle localities
+// skewed: Pareto distributed (alpha = 1.1, at least 1 element), mostly short
+//         segments with a few very long ones
+enum class segment_distribution
+{
+    short_segments,
+    long_segments,
+    skewed_segments
+};
+
+segment_distribution parse_segment_distribution(std::string const& name)
+{
+    if (name == "short")
+        return segment_distribution::short_segments;
+    if (name == "long")
+        return segment_distribution::long_segments;
+    if (name == "skewed")
+        return segment_distribution::skewed_segments;
+    throw std::invalid_argument("unknown segment_distribution: " + name);
+}
+
+std::size_t draw_segment_length(segment_distribution distribution, std::mt19937_64& gen)
+{
+    switch (distribution)
+    {
+    case segment_distribution::short_segments:
+        return std::uniform_int_distribution<std::size_t>(1, 32)(gen);
+    case segment_distribution::long_segments:
+        return std::uniform_int_distribution<std::size_t>(1 << 16, 1 << 18)(gen);
+    case segment_distribution::skewed_segments:
+    default:
+    {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+        double length = std::pow(1.0 - u, -1.0 / 1.1);
+        return length < 1e12 ? static_cast<std::size_t>(length) : std::size_t(1e12);
+    }
+    }
+}
+
+// Mark the segment heads in [first, last). The range is filled in blocks of
+// 2^20 elements with independent random streams, the first segment of every
+// block starts at a random position of a freshly drawn segment.
+template <typename FlagIter>
+void generate_segment_heads(FlagIter first, FlagIter last,
+    segment_distribution distribution, std::uint64_t seed, std::size_t this_locality)
+{
+    constexpr std::size_t block_size = std::size_t(1) << 20;
+    std::size_t const count = std::distance(first, last);
+    std::size_t const num_blocks = (count + block_size - 1) / block_size;
+
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_blocks,
+        [&](std::size_t b) {
+            std::seed_seq seq{seed, std::uint64_t(this_locality), std::uint64_t(b)};
+            std::mt19937_64 gen(seq);
+
+            std::size_t const begin = b * block_size;
+            std::size_t const end = (std::min)(begin + block_size, count);
+            std::fill(first + begin, first + end, FLAGTYPE(0));
+
+            std::size_t length = draw_segment_length(distribution, gen);
+            std::size_t pos = begin +
+                std::uniform_int_distribution<std::size_t>(0, length - 1)(gen);
+            while (pos < end)
+            {
+                first[pos] = FLAGTYPE(1);
+                pos += draw_segment_length(distribution, gen);
+            }
+        });
+}
+
+// Segmented inclusive scan of [first, last) with the head flags starting at
+// flags into dest. The range is split into num_chunks chunks: the chunks are
+// reduced in parallel, combined into chunk prefixes, and scanned in parallel
+// with the carry-in returned by exchange_carry for the sum of the range.
+template <typename Iter, typename FlagIter, typename OutIter,
+    typename ExchangeCarry>
+void segmented_inclusive_scan(Iter first, Iter last, FlagIter flags,
+    OutIter dest, std::size_t num_chunks, ExchangeCarry&& exchange_carry)
+{
+    using T = typename std::iterator_traits<Iter>::value_type;
+    segmented_plus<T> op;
+
+    std::size_t const count = std::distance(first, last);
+    num_chunks = (std::max)(std::size_t(1), (std::min)(num_chunks, count));
+    std::size_t const chunk_size = (count + num_chunks - 1) / num_chunks;
+    if (chunk_size != 0)
+    {
+        num_chunks = (count + chunk_size - 1) / chunk_size;
+    }
+
+    // sums[k] becomes the sum of all chunks in front of chunk k
+    std::vector<segmented_value<T>> sums(num_chunks + 1, segmented_value<T>{T(0), 0});
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_chunks,
+        [&](std::size_t k) {
+            std::size_t const begin = (std::min)(k * chunk_size, count);
+            std::size_t const end = (std::min)(begin + chunk_size, count);
+            segmented_value<T> sum{T(0), 0};
+            for (std::size_t i = begin; i != end; ++i)
+            {
+                if (flags[i])
+                {
+                    sum.value = first[i];
+                    sum.head = 1;
+                }
+                else
+                {
+                    sum.value += first[i];
+                }
+            }
+            sums[k + 1] = sum;
+        });
+    for (std::size_t k = 0; k != num_chunks; ++k)
+    {
+        sums[k + 1] = op(sums[k], sums[k + 1]);
+    }
+
+    segmented_value<T> carry = exchange_carry(sums[num_chunks]);
+
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_chunks,
+        [&](std::size_t k) {
+            std::size_t const begin = (std::min)(k * chunk_size, count);
+            std::size_t const end = (std::min)(begin + chunk_size, count);
+            // the vector start acts as a segment head, so the running value
+            // does not depend on the head flag of the prefix
+            T running = op(carry, sums[k]).value;
+            for (std::size_t i = begin; i != end; ++i)
+            {
+                running = flags[i] ? T(first[i]) : T(running + first[i]);
+                dest[i] = running;
+            }
+        });
+}
+///////////////////////////////////////////////////////////////////////////////
+//
+// Scan engine.
+//
+// The distributed scan is generic over the operator. With UseIdentity the
+// carry-in is exchanged as plain value of the operator and commutative
+// operators are reduced with hpx::reduce. The generic path only needs an
+// associative operator: the carry-in is exchanged as optional_value and
+// locality 0 starts its scan with its first element.
+//
+struct scan_context
+{
+    hpx::collectives::channel_communicator comm;
+    std::size_t num_localities;
+    std::size_t this_locality;
+    carry_algorithm algorithm;
+    scan_mode mode;
+    local_scan_variant local_scan;
+    scan_type type;
+    std::size_t chunk_size;
+    std::size_t tile_size;
+    std::size_t pipeline_chunks;
+    std::size_t batch_size;
+};
+
+// The sum of the last locality is not part of any carry-in, so the
+// single-pass kernels do not need it there (on one locality that saves the
+// whole pass).
+bool needs_local_sum(scan_context const& ctx)
+{
+    return ctx.local_scan == local_scan_variant::two_pass ||
+        ctx.this_locality + 1 != ctx.num_localities;
+}
+
+// Main memory traffic of the scan of one element of value_size bytes on this
+// locality (reads plus writes, not counting write allocation) including the
+// reduce for the carry-in. two_pass reads the segment in hpx::reduce and
+// twice in hpx::inclusive_scan, lookback and tiled read it once more after
+// the reduce, pipelined reads it for the chunk sums and for the chunk scans.
+double bytes_per_element(scan_context const& ctx, std::size_t value_size)
+{
+    double reads = 0;
+    if (ctx.mode == scan_mode::pipelined)
+    {
+        reads = 2;
+    }
+    else if (ctx.local_scan == local_scan_variant::two_pass)
+    {
+        reads = 3;
+    }
+    else
+    {
+        reads = needs_local_sum(ctx) ? 2 : 1;
+    }
+    return (reads + 1) * value_size;
+}
+
+// average time of one round and modelled bytes moved per element
+struct scan_result
+{
+    double elapsed;
+    double bytes_per_element;
+};
+
+// carry-in of this locality for the sum local_sum of its segment
+template <bool UseIdentity, typename Op>
+std::optional<typename Op::value_type> exchange_carry(scan_context const& ctx,
+    std::optional<typename Op::value_type> const& local_sum, Op const& op,
+    std::size_t generation, std::vector<hpx::future<void>>& pending_sends)
+{
+    using T = typename Op::value_type;
+
+    if constexpr (UseIdentity)
+    {
+        return exclusive_scan_localities(ctx.comm, ctx.num_localities, ctx.this_locality,
+            local_sum ? *local_sum : Op::identity(), Op::identity(), op, ctx.algorithm,
+            generation, pending_sends);
+    }
+    else
+    {
+        optional_value<T> local{T(), false};
+        if (local_sum)
+        {
+            local = optional_value<T>{*local_sum, true};
+        }
+        optional_value<T> carry = exclusive_scan_localities(ctx.comm, ctx.num_localities,
+            ctx.this_locality, local, optional_value<T>{T(), false}, optional_op<Op>{op},
+            ctx.algorithm, generation, pending_sends);
+        if (!carry.valid)
+        {
+            return std::nullopt;
+        }
+        return carry.value;
+    }
+}
+
+// in-place scan of the local segment [first, last) of the distributed vector
+template <bool UseIdentity, typename Iter, typename Op>
+void distributed_scan(Iter first, Iter last, Op const& op, scan_context const& ctx,
+    std::size_t generation)
+{
+    using T = typename Op::value_type;
+    std::vector<hpx::future<void>> pending_sends;
+
+    if (ctx.mode == scan_mode::pipelined)
+    {
+        pipelined_scan(first, last, first, ctx.pipeline_chunks, op, ctx.type,
+            [&](std::optional<T> const& local_sum) {
+                return exchange_carry<UseIdentity>(ctx, local_sum, op, generation, pending_sends);
+            });
+    }
+    else
+    {
+        // reduce the segment (see needs_local_sum)
+        std::optional<T> local_sum;
+        if (needs_local_sum(ctx))
+        {
+            local_sum = reduce_range<UseIdentity>(first, last, op);
+        }
+
+        // get the sum of all lower localities directly from them
+        std::optional<T> carry = exchange_carry<UseIdentity>(ctx, local_sum, op, generation, pending_sends);
+
+        // make the final scan of the segment and start with the carry-in of this locality
+        local_scan(ctx.local_scan, first, last, first, carry, op, ctx.chunk_size, ctx.tile_size, ctx.type);
+    }
+
+    for (auto& f : pending_sends)
+    {
+        f.get();
+    }
+}
+
+// applies Op to the corresponding elements of two vectors of the same size
+template <typename Op>
+struct elementwise_op
+{
+    Op op;
+
+    template <typename T>
+    std::vector<T> operator()(std::vector<T> const& a, std::vector<T> const& b) const
+    {
+        std::vector<T> result;
+        result.reserve(a.size());
+        for (std::size_t i = 0; i != a.size(); ++i)
+        {
+            result.push_back(op(a[i], b[i]));
+        }
+        return result;
+    }
+};
+
+// carry-ins of this locality for the sums local_sums of all rows, exchanged
+// in a single collective round
+template <bool UseIdentity, typename Op>
+std::vector<std::optional<typename Op::value_type>> exchange_batched_carry(
+    scan_context const& ctx, std::vector<std::optional<typename Op::value_type>> const& local_sums,
+    Op const& op, std::size_t generation, std::vector<hpx::future<void>>& pending_sends)
+{
+    using T = typename Op::value_type;
+    std::size_t const num_rows = local_sums.size();
+    std::vector<std::optional<T>> carries(num_rows);
+
+    if constexpr (UseIdentity)
+    {
+        std::vector<T> local(num_rows);
+        for (std::size_t r = 0; r != num_rows; ++r)
+        {
+            local[r] = local_sums[r] ? *local_sums[r] : Op::identity();
+        }
+        std::vector<T> carry = exclusive_scan_localities(ctx.comm, ctx.num_localities,
+            ctx.this_locality, local, std::vector<T>(num_rows, Op::identity()),
+            elementwise_op<Op>{op}, ctx.algorithm, generation, pending_sends);
+        for (std::size_t r = 0; r != num_rows; ++r)
+        {
+            carries[r] = carry[r];
+        }
+    }
+    else
+    {
+        std::vector<optional_value<T>> local(num_rows, optional_value<T>{T(), false});
+        for (std::size_t r = 0; r != num_rows; ++r)
+        {
+            if (local_sums[r])
+            {
+                local[r] = optional_value<T>{*local_sums[r], true};
+            }
+        }
+        std::vector<optional_value<T>> carry = exclusive_scan_localities(ctx.comm,
+            ctx.num_localities, ctx.this_locality, local,
+            std::vector<optional_value<T>>(num_rows, optional_value<T>{T(), false}),
+            elementwise_op<optional_op<Op>>{optional_op<Op>{op}}, ctx.algorithm,
+            generation, pending_sends);
+        for (std::size_t r = 0; r != num_rows; ++r)
+        {
+            if (carry[r].valid)
+            {
+                carries[r] = carry[r].value;
+            }
+        }
+    }
+    return carries;
+}
+
+// in-place scan of the local segment [first, last) holding the local slices
+// of num_rows rows, row r is [row_begin(r), row_begin(r + 1))
+template <bool UseIdentity, typename Iter, typename RowBegin, typename Op>
+void batched_scan(std::size_t num_rows, RowBegin&& row_begin, Op const& op,
+    scan_context const& ctx, std::size_t generation)
+{
+    using T = typename Op::value_type;
+    std::vector<hpx::future<void>> pending_sends;
+
+    // reduce all rows concurrently (see needs_local_sum)
+    std::vector<std::optional<T>> local_sums(num_rows);
+    if (needs_local_sum(ctx))
+    {
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_rows,
+            [&](std::size_t r) {
+                local_sums[r] = reduce_range<UseIdentity>(row_begin(r), row_begin(r + 1), op);
+            });
+    }
+
+    std::vector<std::optional<T>> carries =
+        exchange_batched_carry<UseIdentity>(ctx, local_sums, op, generation, pending_sends);
+
+    // scan all rows concurrently, every row starts with its own carry-in
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_rows,
+        [&](std::size_t r) {
+            Iter first = row_begin(r);
+            Iter last = row_begin(r + 1);
+            local_scan(ctx.local_scan, first, last, first, carries[r], op, ctx.chunk_size, ctx.tile_size, ctx.type);
+        });
+
+    for (auto& f : pending_sends)
+    {
+        f.get();
+    }
+}
+
+// Scan all batch_size rows of the local segment [first, last). generation
+// is advanced once per collective round.
+template <bool UseIdentity, typename Iter, typename Op>
+void scan_batch(Iter first, Iter last, Op const& op, scan_context const& ctx,
+    std::size_t& generation)
+{
+    // logical row r of the batch is the slice [r * n / rows, (r + 1) * n / rows)
+    // of the n elements of the local segment on every locality
+    std::size_t const count = std::distance(first, last);
+    auto row_begin = [&](std::size_t r) { return first + r * count / ctx.batch_size; };
+
+    if (ctx.mode == scan_mode::batched)
+    {
+        batched_scan<UseIdentity, Iter>(ctx.batch_size, row_begin, op, ctx, ++generation);
+        return;
+    }
+
+    for (std::size_t r = 0; r != ctx.batch_size; ++r)
+    {
+        distributed_scan<UseIdentity>(row_begin(r), row_begin(r + 1), op, ctx, ++generation);
+    }
+}
+
+// Run the scan benchmark for batch_size vectors of size elements of the
+// value_type of Op, the time is the average time of one scan of the batch.
+template <typename Op>
+scan_result run_scan_benchmark(scan_context const& ctx, VALUETYPE size, bool use_identity,
+    int warmup_loop_count, int loop_count)
+{
+    using T = typename Op::value_type;
+    Op op;
+
+    char const* const vector_name_1 =
+        "partitioned_vector_1";
+
+    // create vector on one locality, connect to it from all others
+    hpx::partitioned_vector<T> main_vector;
+    if (0 == ctx.this_locality)
+    {
+        std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+        main_vector = hpx::partitioned_vector<T>(size * ctx.batch_size, hpx::container_layout(localities));
+        main_vector.register_as(vector_name_1);
+    }
+    else
+    {
+        hpx::future<void> f1 = main_vector.connect_to(vector_name_1);
+        f1.get();
+    }
+
+    // fill the partitioned vector main_vector with the samples of the operator
+    // (2 for the sum, see the example below)
+    partitioned_vector_view<T> main_vector_view(main_vector);
+    std::size_t const local_size = main_vector_view.size();
+    auto local_begin = main_vector_view.begin();
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), local_size,
+        [&](std::size_t i) { local_begin[i] = Op::sample(ctx.this_locality * local_size + i); });
+
+    // Situation example (main_vector):
+    // 3 Localities (Lx) and a vector size of 15:
+    // L0 main_vector_view(5) 2 2 2 2 2
+    // L1 main_vector_view(5)           2 2 2 2 2
+    // L2 main_vector_view(5)                     2 2 2 2 2
+    // main_vector:           2 2 2 2 2 2 2 2 2 2 2 2 2 2 2
+
+    std::size_t generation = 0;
+
+    auto scan_round = [&]() {
+        if constexpr (has_identity<Op>::value)
+        {
+            if (use_identity)
+            {
+                scan_batch<true>(main_vector_view.begin(), main_vector_view.end(), op, ctx, generation);
+                return;
+            }
+        }
+        scan_batch<false>(main_vector_view.begin(), main_vector_view.end(), op, ctx, generation);
+    };
+
+    // warm-up cache
+    for (int round = 1; round <= warmup_loop_count; ++round) {
+        scan_round();
+        }
+
+    //start timer
+    hpx::chrono::high_resolution_timer t;
+    for (int round = 1; round <= loop_count; ++round) {
+        scan_round();
+        }
+    //end timer
+    double elapsed = t.elapsed() / loop_count;
+
+    // Wait for all localities to finish before main_vector goes away.
+    hpx::distributed::barrier::synchronize();
+
+    return scan_result{elapsed, bytes_per_element(ctx, sizeof(T))};
+}
+
+// segmented scan of float sums, see above
+scan_result run_segmented_benchmark(scan_context const& ctx, VALUETYPE size,
+    segment_distribution distribution, std::uint64_t seed,
+    int warmup_loop_count, int loop_count)
+{
+    char const* const vector_name_1 =
+        "partitioned_vector_1";
+    char const* const flag_vector_name =
+        "partitioned_flag_vector";
+
+    // create vectors on one locality, connect to them from all others
+    hpx::partitioned_vector<VALUETYPE> main_vector;
+    // same layout as main_vector
+    hpx::partitioned_vector<FLAGTYPE> flag_vector;
+    if (0 == ctx.this_locality)
+    {
+        std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+        main_vector = hpx::partitioned_vector<VALUETYPE>(size, hpx::container_layout(localities));
+        main_vector.register_as(vector_name_1);
+        flag_vector = hpx::partitioned_vector<FLAGTYPE>(size, hpx::container_layout(localities));
+        flag_vector.register_as(flag_vector_name);
+    }
+    else
+    {
+        main_vector.connect_to(vector_name_1).get();
+        flag_vector.connect_to(flag_vector_name).get();
+    }
+
+    // fill the partitioned vector main_vector with numbers 2 per locality
+    partitioned_vector_view<VALUETYPE> main_vector_view(main_vector);
+    hpx::generate(hpx::execution::par, main_vector_view.begin(), main_vector_view.end(),
+                  [&]() { return 2; });
+
+    partitioned_vector_view<FLAGTYPE> flag_vector_view(flag_vector);
+    generate_segment_heads(flag_vector_view.begin(), flag_vector_view.end(),
+        distribution, seed, ctx.this_locality);
+
+    auto scan_round = [&](std::size_t generation) {
+        using segmented_type = segmented_value<VALUETYPE>;
+        std::vector<hpx::future<void>> pending_sends;
+
+        segmented_inclusive_scan(main_vector_view.begin(), main_vector_view.end(), flag_vector_view.begin(),
+            main_vector_view.begin(), ctx.pipeline_chunks, [&](segmented_type const& local_sum) {
+                return exclusive_scan_localities(ctx.comm, ctx.num_localities, ctx.this_locality,
+                    local_sum, segmented_type{VALUETYPE(0), 0}, segmented_plus<VALUETYPE>(), ctx.algorithm, generation, pending_sends);
+            });
+
+        for (auto& f : pending_sends)
+        {
+            f.get();
+        }
+    };
+
+    std::size_t generation = 0;
+
+    // warm-up cache
+    for (int round = 1; round <= warmup_loop_count; ++round) {
+        scan_round(++generation);
+        }
+
+    //start timer
+    hpx::chrono::high_resolution_timer t;
+    for (int round = 1; round <= loop_count; ++round) {
+        scan_round(++generation);
+        }
+    //end timer
+    double elapsed = t.elapsed() / loop_count;
+
+    // Wait for all localities to finish before the vectors go away.
+    hpx::distributed::barrier::synchronize();
+
+    // values and flags are read for the chunk sums and for the scan
+    return scan_result{elapsed, 2.0 * (sizeof(VALUETYPE) + sizeof(FLAGTYPE)) + sizeof(VALUETYPE)};
+}
+///////////////////////////////////////////////////////////////////////////////
+int hpx_main(hpx::program_options::variables_map& vm)
+{
+    VALUETYPE size = vm["maxelems"].as<VALUETYPE>();
+    int loop_count = vm["loop_count"].as<int>();
+    int warmup_loop_count = vm["warmup_loop_count"].as<int>();
+    std::string const op_name = vm["operator"].as<std::string>();
+    bool use_identity = !vm.count("no_identity");
+    segment_distribution distribution =
+        parse_segment_distribution(vm["segment_distribution"].as<std::string>());
+    std::uint64_t seed = vm["seed"].as<std::uint64_t>();
+    
+    scan_context ctx;
+    ctx.num_localities = hpx::get_num_localities(hpx::launch::sync);
+    ctx.this_locality = hpx::get_locality_id();
+    ctx.algorithm = parse_carry_algorithm(vm["carry_algorithm"].as<std::string>());
+    ctx.mode = parse_scan_mode(vm["scan_mode"].as<std::string>());
+    ctx.local_scan = parse_local_scan_variant(vm["local_scan"].as<std::string>());
+    ctx.type = parse_scan_type(vm["scan_type"].as<std::string>());
+    ctx.chunk_size = vm["chunk_size"].as<std::size_t>();
+    if (ctx.chunk_size == 0)
+    {
+        throw std::invalid_argument("chunk_size has to be positive");
+    }
+    ctx.tile_size = vm["tile_size"].as<std::size_t>();
+    ctx.pipeline_chunks = vm["pipeline_chunks"].as<std::size_t>();
+    if (ctx.pipeline_chunks == 0)
+    {
+        ctx.pipeline_chunks = 4 * hpx::get_num_worker_threads();
+    }
+    ctx.batch_size = (std::max)(std::size_t(1), vm["batch_size"].as<std::size_t>());
+    if (ctx.mode == scan_mode::segmented &&
+        (op_name != "plus" || ctx.type != scan_type::inclusive || ctx.batch_size != 1))
+    {
+        throw std::invalid_argument("scan_mode segmented supports only the inclusive plus scan of one vector");
+    }
+    
+    //print vector size
+    if (0 == ctx.this_locality)
+    {
+        std::cout << "Scan Vector Size: " << size << std::endl;
+        std::cout << "Scan Mode: " << vm["scan_mode"].as<std::string>() << std::endl;
+        std::cout << "Local Scan: " << vm["local_scan"].as<std::string>() << std::endl;
+        if (ctx.local_scan == local_scan_variant::tiled)
+        {
+            std::cout << "L2 Cache Size: " << detect_l2_cache_size() << std::endl;
+            std::cout << "Tile Size: " << (ctx.tile_size == 0 ? std::string("auto") : std::to_string(ctx.tile_size)) << std::endl;
+        }
+        std::cout << "Scan Operator: " << op_name << (use_identity ? "" : " (no identity)") << std::endl;
+        std::cout << "Scan Type: " << vm["scan_type"].as<std::string>() << std::endl;
+        std::cout << "Batch Size: " << ctx.batch_size << std::endl;
+        if (ctx.mode == scan_mode::segmented)
+        {
+            std::cout << "Segment Distribution: " << vm["segment_distribution"].as<std::string>() << std::endl;
+        }
+    }
+    
+    char const* const carry_channel_name =
+        "scan_carry_channel";
+    
+    {
+        // point-to-point channels between all localities for the carry-in exchange
+        ctx.comm = hpx::collectives::create_channel_communicator(hpx::launch::sync,
+            carry_channel_name,
+            hpx::collectives::num_sites_arg(ctx.num_localities),
+            hpx::collectives::this_site_arg(ctx.this_locality));
+        
+        scan_result result{};
+        if (ctx.mode == scan_mode::segmented)
+        {
+            result = run_segmented_benchmark(ctx, size, distribution, seed, warmup_loop_count, loop_count);
+        }
+        else if (op_name == "plus")
+        {
+            result = run_scan_benchmark<plus_op<VALUETYPE>>(ctx, size, use_identity, warmup_loop_count, loop_count);
+        }
+        else if (op_name == "max")
+        {
+            result = run_scan_benchmark<max_op<VALUETYPE>>(ctx, size, use_identity, warmup_loop_count, loop_count);
+        }
+        else if (op_name == "affine")
+        {
+            result = run_scan_benchmark<affine_compose>(ctx, size, use_identity, warmup_loop_count, loop_count);
+        }
+        else if (op_name == "count_sum")
+        {
+            result = run_scan_benchmark<count_sum_plus>(ctx, size, use_identity, warmup_loop_count, loop_count);
+        }
+        else
+        {
+            throw std::invalid_argument("unknown operator: " + op_name);
+        }
+        
+        double const elapsed = result.elapsed;
+        hpx::util::format_to(std::cout,
+                "Elapsed Time == {1} [s]\n",
+                elapsed);
+        hpx::util::format_to(std::cout,
+                "Latency per Vector == {1} [s]\n",
+                elapsed / ctx.batch_size);
+        hpx::util::format_to(std::cout,
+                "Throughput == {1} [elements/s]\n",
+                size * ctx.batch_size / elapsed);
+        // modelled from the passes of the kernel (see bytes_per_element),
+        // not measured
+        hpx::util::format_to(std::cout,
+                "Modelled Bytes per Element == {1} [B]\n",
+                result.bytes_per_element);
+    }
+         
+    return hpx::finalize();
+}
+ 
+int main(int argc, char* argv[])
+{
+    // add command line option which controls the random number generator seed
+    using namespace hpx::program_options;
+    options_description desc_commandline(
+        "Usage: " HPX_APPLICATION_STRING " [options]");
+ 
+    desc_commandline.add_options()
+        ("maxelems,m",
+         value<VALUETYPE>()->default_value(1024)
+         ,"size of the vector")
+    
+        ("loop_count"
+        , hpx::program_options::value<int>()->default_value(10)
+        , "number of rounds in performance measurement loop")
+    
+        ("warmup_loop_count"
+        , hpx::program_options::value<int>()->default_value(4)
+        , "number of warmup rounds in cache warmup loop")
+    
+        ("carry_algorithm"
+        , hpx::program_options::value<std::string>()->default_value("tree")
+        , "cross-locality exclusive scan: linear, recursive_doubling or tree")
+    
+        ("local_scan"
+        , hpx::program_options::value<std::string>()->default_value("two_pass")
+        , "local scan kernel: two_pass, lookback or tiled")
+    
+        ("chunk_size"
+        , hpx::program_options::value<std::size_t>()->default_value(32768)
+        , "number of elements per chunk of the lookback kernel")
+    
+        ("tile_size"
+        , hpx::program_options::value<std::size_t>()->default_value(0)
+        , "number of elements per block of the tiled kernel (0: half of the L2 cache)")
+    
+        ("scan_mode"
+        , hpx::program_options::value<std::string>()->default_value("bulk")
+        , "distributed scan: bulk, pipelined, segmented or batched")
+    
+        ("pipeline_chunks"
+        , hpx::program_options::value<std::size_t>()->default_value(0)
+        , "number of chunks per locality in pipelined and segmented mode (0: 4 per worker thread)")
+    
+        ("segment_distribution"
+        , hpx::program_options::value<std::string>()->default_value("short")
+        , "segment lengths of the segmented scan: short, long or skewed")
+    
+        ("seed"
+        , hpx::program_options::value<std::uint64_t>()->default_value(42)
+        , "seed for the placement of the segment heads")
+    
+        ("operator"
+        , hpx::program_options::value<std::string>()->default_value("plus")
+        , "scan operator: plus, max, affine or count_sum")
+    
+        ("scan_type"
+        , hpx::program_options::value<std::string>()->default_value("inclusive")
+        , "scan type: inclusive or exclusive")
+    
+        ("no_identity"
+        , "do not use the identity of the operator (generic scan path)")
+    
+        ("batch_size"
+        , hpx::program_options::value<std::size_t>()->default_value(1)
+        , "number of vectors of maxelems elements scanned per round")
         ;
  
     // run hpx_main on all localities
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+echo "Setting up environment variables"
+spack load benchmark@1.8.3
+spack load hpx@1.9.0
@@ -0,0 +1,518 @@
+#include <hpx/config.hpp>
+#if !defined(HPX_COMPUTE_DEVICE_CODE)
+#include <hpx/algorithm.hpp>
+#include <hpx/hpx.hpp>
+#include <hpx/hpx_init.hpp>
+#include <hpx/include/partitioned_vector.hpp>
+#include <hpx/modules/collectives.hpp>
+#include <hpx/modules/program_options.hpp>
+#include <hpx/serialization/vector.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <hpx/iostream.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+using VALUETYPE = float;
+
+// Define the vector types to be used.
+HPX_REGISTER_PARTITIONED_VECTOR(VALUETYPE)
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+struct partitioned_vector_view
+{
+private:
+    typedef typename hpx::partitioned_vector<T>::iterator global_iterator;
+    typedef typename hpx::partitioned_vector<T>::const_iterator
+        const_global_iterator;
+
+    typedef hpx::traits::segmented_iterator_traits<global_iterator> traits;
+    typedef hpx::traits::segmented_iterator_traits<const_global_iterator>
+        const_traits;
+
+    typedef typename traits::local_segment_iterator local_segment_iterator;
+
+public:
+    typedef typename traits::local_raw_iterator iterator;
+    typedef typename const_traits::local_raw_iterator const_iterator;
+    typedef T value_type;
+
+public:
+    explicit partitioned_vector_view(hpx::partitioned_vector<T>& data)
+      : segment_iterator_(data.segment_begin(hpx::get_locality_id()))
+    {
+    }
+
+    iterator begin()
+    {
+        return traits::begin(segment_iterator_);
+    }
+    iterator end()
+    {
+        return traits::end(segment_iterator_);
+    }
+
+    const_iterator begin() const
+    {
+        return const_traits::begin(segment_iterator_);
+    }
+    const_iterator end() const
+    {
+        return const_traits::end(segment_iterator_);
+    }
+
+    value_type& operator[](std::size_t index)
+    {
+        return (*segment_iterator_)[index];
+    }
+    value_type const& operator[](std::size_t index) const
+    {
+        return (*segment_iterator_)[index];
+    }
+
+    std::size_t size() const
+    {
+        return (*segment_iterator_).size();
+    }
+
+private:
+    local_segment_iterator segment_iterator_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Jacobi stencil.
+//
+// The vector is a grid of rows of width elements (width 1: the 1D stencil),
+// every locality holds the rows of its part of the vector. Elements behind
+// the last full row of a locality are not part of the grid. Every iteration
+// computes u_new from u and swaps both:
+// 1D: u_new[i] = (u[i - 1] + u[i + 1]) / 2
+// 2D: u_new[r][c] = (u[r - 1][c] + u[r + 1][c] + u[r][c - 1] + u[r][c + 1]) / 4
+// The first and last row of the grid and (2D) its first and last column are
+// fixed to 1, the other elements start with 0.
+//
+// The first and the last local row need the neighbouring row of the left and
+// the right locality (halo), which is exchanged over a channel_communicator
+// in every iteration. Every other row is an interior row.
+//
+// barrier:   receive the halos, update all rows and wait at a global barrier
+//            before the next iteration (bulk synchronous).
+// futurized: the interior rows are updated while the halos are in transfer,
+//            every boundary row is updated as soon as its halo has arrived.
+//            No global synchronization, a locality only waits for its
+//            neighbours.
+//
+// Besides the time per iteration the update alone (with the last halos) and
+// the halo exchange alone are measured. The overlap efficiency is the part of
+// the shorter of both which is hidden by the other one:
+// (compute + exchange - iteration) / min(compute, exchange)
+// 1 means complete overlap, 0 no overlap at all. On a single locality there
+// is no halo to hide, so the efficiency is printed as n/a.
+//
+// Situation example (2 Localities, 1D, 4 elements each):
+// L0 u 1 0 0 0 | L1 u 0 0 0 1
+// halos: L0 gets 0 (first element of L1), L1 gets 0 (last element of L0)
+// L0 u_new 1 0.5 0 0 | L1 u_new 0 0 0.5 1
+//
+enum class stencil_mode
+{
+    barrier,
+    futurized
+};
+
+stencil_mode parse_stencil_mode(std::string const& name)
+{
+    if (name == "barrier")
+        return stencil_mode::barrier;
+    if (name == "futurized")
+        return stencil_mode::futurized;
+    throw std::invalid_argument("unknown stencil_mode: " + name);
+}
+
+using halo_type = std::vector<VALUETYPE>;
+
+// update of the row between up and down into row_new, the first and the last
+// column of the 2D stencil are fixed
+inline void jacobi_row(VALUETYPE const* up, VALUETYPE const* row,
+    VALUETYPE const* down, VALUETYPE* row_new, std::size_t width)
+{
+    if (width == 1)
+    {
+        row_new[0] = (up[0] + down[0]) / 2;
+        return;
+    }
+    row_new[0] = row[0];
+    for (std::size_t c = 1; c + 1 < width; ++c)
+    {
+        row_new[c] = (up[c] + down[c] + row[c - 1] + row[c + 1]) / 4;
+    }
+    row_new[width - 1] = row[width - 1];
+}
+
+// Update of the interior rows [1, rows - 1) of u, returns what for_loop
+// returns with policy
+template <typename ExPolicy>
+auto jacobi_interior(ExPolicy&& policy, VALUETYPE const* u, VALUETYPE* u_new,
+    std::size_t width, std::size_t rows)
+{
+    return hpx::experimental::for_loop(policy, std::size_t(1), rows - 1,
+        [=](std::size_t r) {
+            jacobi_row(u + (r - 1) * width, u + r * width, u + (r + 1) * width,
+                u_new + r * width, width);
+        });
+}
+
+// Update of the boundary row r (0 or rows - 1) of u with the halo of the
+// neighbour, a fixed row is copied
+inline void jacobi_boundary(VALUETYPE const* u, VALUETYPE* u_new, std::size_t width,
+    std::size_t rows, std::size_t r, halo_type const& halo, bool fixed)
+{
+    VALUETYPE const* row = u + r * width;
+    if (fixed)
+    {
+        std::copy(row, row + width, u_new + r * width);
+        return;
+    }
+    VALUETYPE const* up = r == 0 ? halo.data() : row - width;
+    VALUETYPE const* down = r == 0 ? row + width : halo.data();
+    jacobi_row(up, row, down, u_new + r * width, width);
+}
+
+// Jacobi iterations on the grid of u and u_new, which are filled with the
+// initial values. Every locality prints its timings, locality 0 the checksum
+// of the grid after the warm-up and the measured iterations.
+void run_stencil(hpx::partitioned_vector<VALUETYPE>& u_vector,
+    hpx::partitioned_vector<VALUETYPE>& u_new_vector,
+    hpx::collectives::channel_communicator comm, stencil_mode mode,
+    std::size_t width, std::size_t rows, int loop_count, int warmup_loop_count)
+{
+    using hpx::collectives::get;
+    using hpx::collectives::set;
+    using hpx::collectives::that_site_arg;
+    using hpx::collectives::tag_arg;
+
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const this_locality = hpx::get_locality_id();
+    bool const has_left = this_locality != 0;
+    bool const has_right = this_locality + 1 != num_localities;
+
+    partitioned_vector_view<VALUETYPE> view_u(u_vector);
+    partitioned_vector_view<VALUETYPE> view_u_new(u_new_vector);
+    VALUETYPE* u = &*view_u.begin();
+    VALUETYPE* u_new = &*view_u_new.begin();
+
+    // last received halos, the compute only measurement works on them
+    halo_type above(width, 1);
+    halo_type below(width, 1);
+
+    // iteration generation of the channel tags, the first row goes to the
+    // left (step 0), the last row to the right (step 1)
+    std::size_t generation = 0;
+    auto tag = [](std::size_t generation, std::size_t step) {
+        return tag_arg(2 * generation + step);
+    };
+
+    // sends the boundary rows of u to the neighbours
+    auto send_halos = [&](std::size_t generation, std::vector<hpx::future<void>>& pending_sends) {
+        if (has_left)
+        {
+            pending_sends.push_back(set(comm, that_site_arg(this_locality - 1),
+                halo_type(u, u + width), tag(generation, 0)));
+        }
+        if (has_right)
+        {
+            pending_sends.push_back(set(comm, that_site_arg(this_locality + 1),
+                halo_type(u + (rows - 1) * width, u + rows * width), tag(generation, 1)));
+        }
+    };
+
+    // halos of the neighbours, a missing neighbour keeps the old halo
+    auto receive_halo = [&](bool has_neighbour, std::size_t neighbour, std::size_t generation,
+                            std::size_t step, halo_type const& old) -> hpx::future<halo_type> {
+        if (has_neighbour)
+        {
+            return get<halo_type>(comm, that_site_arg(neighbour), tag(generation, step));
+        }
+        return hpx::make_ready_future(old);
+    };
+
+    auto iteration = [&]() {
+        ++generation;
+        std::vector<hpx::future<void>> pending_sends;
+        send_halos(generation, pending_sends);
+        hpx::future<halo_type> from_left =
+            receive_halo(has_left, this_locality - 1, generation, 1, above);
+        hpx::future<halo_type> from_right =
+            receive_halo(has_right, this_locality + 1, generation, 0, below);
+
+        if (mode == stencil_mode::barrier)
+        {
+            above = from_left.get();
+            below = from_right.get();
+            jacobi_interior(hpx::execution::par, u, u_new, width, rows);
+            jacobi_boundary(u, u_new, width, rows, 0, above, !has_left);
+            jacobi_boundary(u, u_new, width, rows, rows - 1, below, !has_right);
+            hpx::wait_all(pending_sends);
+            hpx::distributed::barrier::synchronize();
+        }
+        else
+        {
+            hpx::future<void> interior =
+                jacobi_interior(hpx::execution::par(hpx::execution::task), u, u_new, width, rows);
+            hpx::future<void> first = from_left.then([&](hpx::future<halo_type> halo) {
+                above = halo.get();
+                jacobi_boundary(u, u_new, width, rows, 0, above, !has_left);
+            });
+            hpx::future<void> last = from_right.then([&](hpx::future<halo_type> halo) {
+                below = halo.get();
+                jacobi_boundary(u, u_new, width, rows, rows - 1, below, !has_right);
+            });
+            hpx::wait_all(interior, first, last);
+            hpx::wait_all(pending_sends);
+        }
+        std::swap(u, u_new);
+    };
+
+    // update only, with the last halos
+    auto compute_only = [&]() {
+        jacobi_interior(hpx::execution::par, u, u_new, width, rows);
+        jacobi_boundary(u, u_new, width, rows, 0, above, !has_left);
+        jacobi_boundary(u, u_new, width, rows, rows - 1, below, !has_right);
+        std::swap(u, u_new);
+    };
+
+    // halo exchange only
+    auto exchange_only = [&]() {
+        ++generation;
+        std::vector<hpx::future<void>> pending_sends;
+        send_halos(generation, pending_sends);
+        above = receive_halo(has_left, this_locality - 1, generation, 1, above).get();
+        below = receive_halo(has_right, this_locality + 1, generation, 0, below).get();
+        hpx::wait_all(pending_sends);
+    };
+
+    // time per round of round_function
+    auto measure = [&](auto round_function) {
+        hpx::chrono::high_resolution_timer t;
+        for (int round = 1; round <= loop_count; ++round) {
+            round_function();
+        }
+        return t.elapsed() / loop_count;
+    };
+
+    for (int round = 1; round <= warmup_loop_count; ++round) {
+        iteration();
+    }
+    double const elapsed = measure(iteration);
+
+    // the grid after warmup_loop_count + loop_count iterations is in the
+    // vector u points to
+    hpx::distributed::barrier::synchronize();
+    if (0 == this_locality)
+    {
+        hpx::partitioned_vector<VALUETYPE>& result =
+            u == &*view_u.begin() ? u_vector : u_new_vector;
+        double const checksum = hpx::reduce(hpx::execution::par, result.begin(), result.end(),
+            0.0, std::plus<double>());
+        hpx::util::format_to(std::cout,
+                "Checksum == {1}\n",
+                checksum);
+    }
+    hpx::distributed::barrier::synchronize();
+
+    double const compute = measure(compute_only);
+    double const exchange = measure(exchange_only);
+
+    hpx::util::format_to(std::cout,
+            "Elapsed Time == {1} [s]\n",
+            elapsed);
+    hpx::util::format_to(std::cout,
+            "Element Rate == {1} [Gelements/s]\n",
+            rows * width / elapsed / 1e9);
+    std::string const efficiency = num_localities > 1 ?
+        hpx::util::format("{1}", (compute + exchange - elapsed) / (std::min)(compute, exchange)) :
+        std::string("n/a");
+    std::string const timings = hpx::util::format(
+            "Locality {1} Iteration:\n"
+            "Time per Iteration == {2} [s]\n"
+            "Compute Time per Iteration == {3} [s]\n"
+            "Halo Exchange Time per Iteration == {4} [s]\n"
+            "Overlap Efficiency == {5}\n",
+            this_locality, elapsed, compute, exchange, efficiency);
+    std::cout << timings << std::flush;
+
+    hpx::distributed::barrier::synchronize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int hpx_main(hpx::program_options::variables_map& vm)
+{
+    VALUETYPE size = vm["maxelems"].as<VALUETYPE>();
+    int loop_count = vm["loop_count"].as<int>();
+    int warmup_loop_count = vm["warmup_loop_count"].as<int>();
+    stencil_mode mode = parse_stencil_mode(vm["stencil_mode"].as<std::string>());
+    int const dimension = vm["dimension"].as<int>();
+    std::size_t width = vm["width"].as<std::size_t>();
+    if (dimension == 1)
+    {
+        width = 1;
+    }
+    else if (dimension == 2)
+    {
+        // 0: square grid
+        if (width == 0)
+        {
+            width = static_cast<std::size_t>(std::sqrt(static_cast<double>(size)));
+        }
+        if (width < 3)
+        {
+            throw std::invalid_argument("the 2D stencil needs a width of at least 3");
+        }
+    }
+    else
+    {
+        throw std::invalid_argument("unknown dimension: " + std::to_string(dimension));
+    }
+
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const this_locality = hpx::get_locality_id();
+
+    //print vector size
+    if (0 == this_locality)
+    {
+        hpx::cout << "Stencil Vector Size: " << size << "\n" << std::flush;
+        hpx::cout << "Stencil Mode: " << vm["stencil_mode"].as<std::string>() << "\n" << std::flush;
+        hpx::cout << "Dimension: " << dimension << "\n" << std::flush;
+        hpx::cout << "Width: " << width << "\n" << std::flush;
+    }
+
+    char const* const vector_name_u =
+        "u_vector";
+    char const* const vector_name_u_new =
+        "u_new_vector";
+    char const* const halo_channel_name =
+        "stencil_halo_channel";
+
+    {
+        // create vector on one locality, connect to it from all others
+        hpx::partitioned_vector<VALUETYPE> u;
+        hpx::partitioned_vector<VALUETYPE> u_new;
+
+        if (0 == this_locality)
+        {
+            std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+            u = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(localities));
+            u.register_as(vector_name_u);
+
+            u_new = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(localities));
+            u_new.register_as(vector_name_u_new);
+        }
+        else
+        {
+            hpx::future<void> f1 = u.connect_to(vector_name_u);
+            hpx::future<void> f2 = u_new.connect_to(vector_name_u_new);
+            f1.get();
+            f2.get();
+        }
+
+        partitioned_vector_view<VALUETYPE> view_u(u);
+        partitioned_vector_view<VALUETYPE> view_u_new(u_new);
+        std::size_t const rows = view_u.size() / width;
+        if (rows < 2)
+        {
+            throw std::invalid_argument("every locality needs at least 2 rows");
+        }
+
+        // 1 on the fixed first and last row of the grid and (2D) on the first
+        // and last column, 0 everywhere else
+        bool const first_locality = this_locality == 0;
+        bool const last_locality = this_locality + 1 == num_localities;
+        auto initial = [&](std::size_t i) -> VALUETYPE {
+            std::size_t const r = i / width;
+            std::size_t const c = i % width;
+            if (r >= rows)
+                return 0;
+            if ((first_locality && r == 0) || (last_locality && r + 1 == rows))
+                return 1;
+            return (width > 1 && (c == 0 || c + 1 == width)) ? 1 : 0;
+        };
+        partitioned_vector_view<VALUETYPE>::iterator const first_u = view_u.begin();
+        partitioned_vector_view<VALUETYPE>::iterator const first_u_new = view_u_new.begin();
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), view_u.size(),
+            [&](std::size_t i) {
+                first_u[i] = initial(i);
+                first_u_new[i] = initial(i);
+            });
+
+        // point-to-point channels to the neighbours, created once outside
+        // of the measurement
+        hpx::collectives::channel_communicator comm =
+            hpx::collectives::create_channel_communicator(hpx::launch::sync,
+                halo_channel_name,
+                hpx::collectives::num_sites_arg(num_localities),
+                hpx::collectives::this_site_arg(this_locality));
+
+        run_stencil(u, u_new, comm, mode, width, rows, loop_count, warmup_loop_count);
+    }
+
+    return hpx::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    // add command line option which controls the random number generator seed
+    using namespace hpx::program_options;
+    options_description desc_commandline(
+        "Usage: " HPX_APPLICATION_STRING " [options]");
+
+    desc_commandline.add_options()
+        ("maxelems,m",
+         value<VALUETYPE>()->default_value(1024)
+         ,"size of the vector")
+
+        ("loop_count"
+        , hpx::program_options::value<int>()->default_value(10)
+        , "number of iterations in performance measurement loop")
+
+        ("warmup_loop_count"
+        , hpx::program_options::value<int>()->default_value(4)
+        , "number of warmup iterations in cache warmup loop")
+
+        ("stencil_mode"
+        , hpx::program_options::value<std::string>()->default_value("barrier")
+        , "halo exchange: barrier (global barrier every iteration) or futurized (interior update overlaps the halo transfer)")
+
+        ("dimension"
+        , hpx::program_options::value<int>()->default_value(1)
+        , "dimension of the stencil: 1 or 2")
+
+        ("width"
+        , hpx::program_options::value<std::size_t>()->default_value(0)
+        , "row width of the 2D grid, 0 for a square grid")
+        ;
+
+    // run hpx_main on all localities
+    std::vector<std::string> const cfg = {"hpx.run_hpx_main!=1"};
+
+    // Initialize and run HPX
+    hpx::init_params init_args;
+    init_args.desc_cmdline = desc_commandline;
+    init_args.cfg = cfg;
+
+    return hpx::init(argc, argv, init_args);
+}
+#endif
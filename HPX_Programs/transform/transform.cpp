@@ -7,20 +7,52 @@
 
 #include <hpx/modules/program_options.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
 #include <iostream>
 #include <random>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <hpx/iostream.hpp>
 
+#include "compressed.hpp"
+#include "storage.hpp"
+#include "streaming_store.hpp"
+
 ///////////////////////////////////////////////////////////////////////////////
 using VALUETYPE = float;
 
+// reduced precision storage types, see reduced precision storage
+using numa::bfloat16;
+using numa::float16;
+using numa::int8_scaled;
+using numa::int16_scaled;
+using numa::storage_codec;
+
+// formats and words of the compressed storage, see compressed storage
+using numa::bitpacked_format;
+using numa::delta_for_format;
+using numa::uncompressed_format;
+using compressed_word = std::uint32_t;
+
 // Define the vector types to be used.
 HPX_REGISTER_PARTITIONED_VECTOR(VALUETYPE)
+HPX_REGISTER_PARTITIONED_VECTOR(bfloat16)
+HPX_REGISTER_PARTITIONED_VECTOR(float16)
+HPX_REGISTER_PARTITIONED_VECTOR(int8_scaled)
+HPX_REGISTER_PARTITIONED_VECTOR(int16_scaled)
+HPX_REGISTER_PARTITIONED_VECTOR(compressed_word)
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -101,37 +133,113 @@ private:
 };
 
 ///////////////////////////////////////////////////////////////////////////////
-int hpx_main(hpx::program_options::variables_map& vm)
+//
+// Reduced precision storage.
+//
+// The vectors are stored as bfloat16, float16 (IEEE half precision), or as 8
+// or 16 bit integers with a scale (value = integer * scale). The transform
+// converts the stored elements to float in software, adds them in float and
+// converts the result back. Halving the bytes per element should nearly
+// double the elements per second of this memory bound kernel, so both rates
+// are reported.
+//
+// The storage types and their codecs are shared with numa_v1, see
+// include/storage.hpp.
+//
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Streaming stores.
+//
+// A store to a cache line which is not in the cache reads the line from
+// memory first (write allocate). Non-temporal (streaming) stores write whole
+// lines to memory without reading them and without evicting other lines from
+// the caches. They only pay off for vectors much larger than the last level
+// cache, so they are chosen automatically if the local parts of the vectors of
+// a kernel are larger than streaming_threshold bytes. The stores themselves
+// are shared with numa_v1, see include/streaming_store.hpp.
+//
+// The transform v = v + y reads the lines of v anyway, streaming stores only
+// keep v out of the caches there. The STREAM kernels write a vector which they
+// do not read and save its write allocate traffic.
+//
+// Situation example (threshold 256 MiB, 1 Locality, 3 vectors):
+// 2^24 elements  192 MiB  cached stores
+// 2^25 elements  384 MiB  streaming stores
+//
+enum class streaming_stores
 {
-    VALUETYPE size = vm["maxelems"].as<VALUETYPE>();
-    int loop_count = vm["loop_count"].as<int>();
-    int warmup_loop_count = vm["warmup_loop_count"].as<int>();
-    
-    //print vector size
-    if (0 == hpx::get_locality_id())
-    {
-        hpx::cout << "Transform Vector Size: " << size << "\n" << std::flush;
-    }
+    automatic,
+    on,
+    off
+};
 
+streaming_stores parse_streaming_stores(std::string const& name)
+{
+    if (name == "auto")
+        return streaming_stores::automatic;
+    if (name == "on")
+        return streaming_stores::on;
+    if (name == "off")
+        return streaming_stores::off;
+    throw std::invalid_argument("unknown streaming_stores: " + name);
+}
+
+// true if a kernel over bytes of local vectors uses streaming stores
+inline bool use_streaming(streaming_stores mode, std::size_t bytes, std::size_t threshold)
+{
+    return mode == streaming_stores::on ||
+        (mode == streaming_stores::automatic && bytes > threshold);
+}
+
+// stream_transform of [0, count) in 4 blocks per worker thread, the blocks
+// start at whole cache lines of 16 elements
+template <typename Op>
+void par_stream_transform(VALUETYPE const* a, VALUETYPE const* b, VALUETYPE* out,
+    std::size_t count, Op op)
+{
+    constexpr std::size_t line = 64 / sizeof(VALUETYPE);
+    std::size_t const num_blocks = (std::max)(std::size_t(1),
+        (std::min)(count / line, std::size_t(4 * hpx::get_num_worker_threads())));
+    std::size_t const block_size = ((count + num_blocks - 1) / num_blocks + line - 1) / line * line;
+
+    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_blocks,
+        [=](std::size_t k) {
+            std::size_t const begin = (std::min)(k * block_size, count);
+            std::size_t const end = (std::min)(begin + block_size, count);
+            numa::stream_transform(a + begin, b + begin, out + begin, end - begin, op);
+        });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Transform v = v + y over vectors of size elements of type Storage, float
+// vectors with streaming stores depending on streaming and threshold
+template <typename Storage>
+void run_transform(std::size_t size, int loop_count, int warmup_loop_count,
+    streaming_stores streaming, std::size_t threshold)
+{
     char const* const vector_name_v = "v_vector";
     char const* const vector_name_y = "y_vector";
     char const* const latch_name = "latch";
 
+    // v grows by 2 in every round
+    storage_codec<Storage> const codec(1 + 2 * (warmup_loop_count + loop_count));
+
     {
         // create vector on one locality, connect to it from all others
-        hpx::partitioned_vector<VALUETYPE> v;
-        hpx::partitioned_vector<VALUETYPE> y;
+        hpx::partitioned_vector<Storage> v;
+        hpx::partitioned_vector<Storage> y;
         hpx::distributed::latch latch;
 
         if (0 == hpx::get_locality_id())
         {
             std::vector<hpx::id_type> localities = hpx::find_all_localities();
 
-            v = hpx::partitioned_vector<VALUETYPE>(
+            v = hpx::partitioned_vector<Storage>(
                 size, hpx::container_layout(localities));
             v.register_as(vector_name_v);
 
-            y = hpx::partitioned_vector<VALUETYPE>(
+            y = hpx::partitioned_vector<Storage>(
                 size, hpx::container_layout(localities));
             y.register_as(vector_name_y);
 
@@ -148,60 +256,1681 @@ int hpx_main(hpx::program_options::variables_map& vm)
         }
 
         // fill the vector v with 1
-        partitioned_vector_view<VALUETYPE> view_v(v);
+        partitioned_vector_view<Storage> view_v(v);
+        Storage const one = codec.encode(1);
         hpx::generate(hpx::execution::par, view_v.begin(), view_v.end(),
-            [&]() { return 1; });
+            [&]() { return one; });
 
         // fill the vector y with 2
-        partitioned_vector_view<VALUETYPE> view_y(y);
+        partitioned_vector_view<Storage> view_y(y);
+        Storage const two = codec.encode(2);
         hpx::generate(hpx::execution::par, view_y.begin(), view_y.end(),
-            [&]() { return 2; });
+            [&]() { return two; });
+        
+        bool const stream = std::is_same<Storage, VALUETYPE>::value &&
+            use_streaming(streaming, 2 * view_v.size() * sizeof(Storage), threshold);
+        
+        // Transform the values of view_v by adding the corresponding values from view_y
+        auto transform_round = [&]() {
+            if constexpr (std::is_same<Storage, VALUETYPE>::value)
+            {
+                if (stream)
+                {
+                    par_stream_transform(&*view_v.begin(), &*view_y.begin(), &*view_v.begin(),
+                        view_v.size(), [](VALUETYPE v, VALUETYPE y) { return v + y; });
+                    return;
+                }
+            }
+            hpx::transform(hpx::execution::par, view_v.begin(), view_v.end(), view_y.begin(), view_v.begin(),
+                       [codec](Storage v, Storage y) { return codec.encode(codec.decode(v) + codec.decode(y)); });
+        };
         
         // warm-up cache
         for (int round = 1; round <= warmup_loop_count; ++round) {
-            // Transform the values of view_v by adding the corresponding values from view_y
-            hpx::transform(hpx::execution::par, view_v.begin(), view_v.end(), view_y.begin(), view_v.begin(),
-                       [](VALUETYPE v, VALUETYPE y) { return v + y; });
+            transform_round();
             }
         
         //start timer
         hpx::chrono::high_resolution_timer t;
         for (int round = 1; round <= loop_count; ++round) {
-            // Transform the values of view_v by adding the corresponding values from view_y
-            hpx::transform(hpx::execution::par, view_v.begin(), view_v.end(), view_y.begin(), view_v.begin(),
-                       [](VALUETYPE v, VALUETYPE y) { return v + y; });
+            transform_round();
             }
         //end timer
         double elapsed = t.elapsed() / loop_count;
         hpx::util::format_to(std::cout,
                 "Elapsed Time == {1} [s]\n",
                 elapsed);
+        // v and y are read, v is written
+        hpx::util::format_to(std::cout,
+                "Bandwidth == {1} [GB/s]\n",
+                3.0 * size * sizeof(Storage) / elapsed / 1e9);
+        hpx::util::format_to(std::cout,
+                "Element Rate == {1} [Gelements/s]\n",
+                size / elapsed / 1e9);
+        hpx::util::format_to(std::cout,
+                "Streaming Stores == {1}\n",
+                stream ? "on" : "off");
 
         // Wait for all localities to reach this point.
         latch.arrive_and_wait();
     }
-    return hpx::finalize();
 }
 
-int main(int argc, char* argv[])
+///////////////////////////////////////////////////////////////////////////////
+//
+// STREAM kernels.
+//
+// The four kernels of the STREAM benchmark over three separate vectors a, b
+// and c of VALUETYPE, with the scalar 3:
+// copy:  c = a
+// scale: b = scalar * c
+// add:   c = a + b
+// triad: a = b + scalar * c
+//
+// Bandwidth counts every vector which is read or written once, like STREAM
+// does. The written vector is not read by the kernel, so a cache with write
+// allocate reads its lines from memory before they are overwritten. The
+// memory traffic is then one vector more, which is reported as Bandwidth with
+// Write Allocate. Streaming stores skip the read, with them both countings
+// agree. The transform above reads the vector it writes, both countings agree
+// for it as well.
+//
+// Situation example (a = 1, b = 2, c = 3 before every kernel):
+// copy  c = 1   2 vectors, 3 with write allocate
+// scale b = 9   2 vectors, 3 with write allocate
+// add   c = 3   3 vectors, 4 with write allocate
+// triad a = 11  3 vectors, 4 with write allocate
+//
+enum class transform_kernel
 {
-    // add command line option which controls the random number generator seed
-    using namespace hpx::program_options;
-    options_description desc_commandline(
-        "Usage: " HPX_APPLICATION_STRING " [options]");
+    inplace,    // v = v + y, see transform
+    copy,
+    scale,
+    add,
+    triad,
+    chain,      // chained transforms, see expression templates
+    gather,     // see gather and scatter
+    scatter,
+    fma         // see arithmetic intensity
+};
 
-    desc_commandline.add_options()
-        ("maxelems,m",
-         value<VALUETYPE>()->default_value(1024)
-         ,"size of the vector")
-    
-        ("loop_count"
-        , hpx::program_options::value<int>()->default_value(10)
-        , "number of rounds in performance measurement loop")
-        
-        ("warmup_loop_count"
-        , hpx::program_options::value<int>()->default_value(4)
-        , "number of warmup rounds in cache warmup loop")
+transform_kernel parse_transform_kernel(std::string const& name)
+{
+    if (name == "inplace")
+        return transform_kernel::inplace;
+    if (name == "copy")
+        return transform_kernel::copy;
+    if (name == "scale")
+        return transform_kernel::scale;
+    if (name == "add")
+        return transform_kernel::add;
+    if (name == "triad")
+        return transform_kernel::triad;
+    if (name == "chain")
+        return transform_kernel::chain;
+    if (name == "gather")
+        return transform_kernel::gather;
+    if (name == "scatter")
+        return transform_kernel::scatter;
+    if (name == "fma")
+        return transform_kernel::fma;
+    throw std::invalid_argument("unknown transform_kernel: " + name);
+}
+
+// One of the STREAM kernels over vectors of size elements
+void run_stream(std::size_t size, transform_kernel kernel, int loop_count, int warmup_loop_count,
+    streaming_stores streaming, std::size_t threshold)
+{
+    char const* const vector_name_a = "a_vector";
+    char const* const vector_name_b = "b_vector";
+    char const* const vector_name_c = "c_vector";
+    char const* const latch_name = "latch";
+
+    VALUETYPE const scalar = 3;
+
+    {
+        // create vector on one locality, connect to it from all others
+        hpx::partitioned_vector<VALUETYPE> a;
+        hpx::partitioned_vector<VALUETYPE> b;
+        hpx::partitioned_vector<VALUETYPE> c;
+        hpx::distributed::latch latch;
+
+        if (0 == hpx::get_locality_id())
+        {
+            std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+            a = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(localities));
+            a.register_as(vector_name_a);
+
+            b = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(localities));
+            b.register_as(vector_name_b);
+
+            c = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(localities));
+            c.register_as(vector_name_c);
+
+            latch = hpx::distributed::latch(localities.size());
+            latch.register_as(latch_name);
+        }
+        else
+        {
+            hpx::future<void> f1 = a.connect_to(vector_name_a);
+            hpx::future<void> f2 = b.connect_to(vector_name_b);
+            hpx::future<void> f3 = c.connect_to(vector_name_c);
+            latch.connect_to(latch_name);
+            f1.get();
+            f2.get();
+            f3.get();
+        }
+
+        // fill the vectors with 1, 2 and 3
+        partitioned_vector_view<VALUETYPE> view_a(a);
+        partitioned_vector_view<VALUETYPE> view_b(b);
+        partitioned_vector_view<VALUETYPE> view_c(c);
+        hpx::fill(hpx::execution::par, view_a.begin(), view_a.end(), VALUETYPE(1));
+        hpx::fill(hpx::execution::par, view_b.begin(), view_b.end(), VALUETYPE(2));
+        hpx::fill(hpx::execution::par, view_c.begin(), view_c.end(), VALUETYPE(3));
+
+        // vectors read and written by the kernel, the written vector and its
+        // value after the kernel
+        std::size_t read = 0;
+        std::size_t const written = 1;
+        partitioned_vector_view<VALUETYPE>* result = nullptr;
+        VALUETYPE expected = 0;
+
+        switch (kernel)
+        {
+        case transform_kernel::copy:
+            read = 1;
+            result = &view_c;
+            expected = 1;
+            break;
+        case transform_kernel::scale:
+            read = 1;
+            result = &view_b;
+            expected = scalar * 3;
+            break;
+        case transform_kernel::add:
+            read = 2;
+            result = &view_c;
+            expected = 1 + 2;
+            break;
+        case transform_kernel::triad:
+        default:
+            read = 2;
+            result = &view_a;
+            expected = 2 + scalar * 3;
+            break;
+        }
+
+        bool const stream = use_streaming(streaming,
+            (read + written) * view_a.size() * sizeof(VALUETYPE), threshold);
+
+        auto stream_round = [&]() {
+            if (stream)
+            {
+                VALUETYPE const* first_a = &*view_a.begin();
+                VALUETYPE const* first_b = &*view_b.begin();
+                VALUETYPE const* first_c = &*view_c.begin();
+                std::size_t const count = view_a.size();
+                switch (kernel)
+                {
+                case transform_kernel::copy:
+                    par_stream_transform(first_a, first_a, &*view_c.begin(), count,
+                        [](VALUETYPE a, VALUETYPE) { return a; });
+                    break;
+                case transform_kernel::scale:
+                    par_stream_transform(first_c, first_c, &*view_b.begin(), count,
+                        [scalar](VALUETYPE c, VALUETYPE) { return scalar * c; });
+                    break;
+                case transform_kernel::add:
+                    par_stream_transform(first_a, first_b, &*view_c.begin(), count,
+                        [](VALUETYPE a, VALUETYPE b) { return a + b; });
+                    break;
+                case transform_kernel::triad:
+                default:
+                    par_stream_transform(first_b, first_c, &*view_a.begin(), count,
+                        [scalar](VALUETYPE b, VALUETYPE c) { return b + scalar * c; });
+                    break;
+                }
+                return;
+            }
+            switch (kernel)
+            {
+            case transform_kernel::copy:
+                hpx::copy(hpx::execution::par, view_a.begin(), view_a.end(), view_c.begin());
+                break;
+            case transform_kernel::scale:
+                hpx::transform(hpx::execution::par, view_c.begin(), view_c.end(), view_b.begin(),
+                    [scalar](VALUETYPE c) { return scalar * c; });
+                break;
+            case transform_kernel::add:
+                hpx::transform(hpx::execution::par, view_a.begin(), view_a.end(), view_b.begin(),
+                    view_c.begin(), [](VALUETYPE a, VALUETYPE b) { return a + b; });
+                break;
+            case transform_kernel::triad:
+            default:
+                hpx::transform(hpx::execution::par, view_b.begin(), view_b.end(), view_c.begin(),
+                    view_a.begin(), [scalar](VALUETYPE b, VALUETYPE c) { return b + scalar * c; });
+                break;
+            }
+        };
+
+        // warm-up cache
+        for (int round = 1; round <= warmup_loop_count; ++round) {
+            stream_round();
+        }
+
+        //start timer
+        hpx::chrono::high_resolution_timer t;
+        for (int round = 1; round <= loop_count; ++round) {
+            stream_round();
+        }
+        //end timer
+        double elapsed = t.elapsed() / loop_count;
+        // streaming stores do not read the lines of the written vector
+        std::size_t const allocated = stream ? 0 : written;
+        hpx::util::format_to(std::cout,
+                "Elapsed Time == {1} [s]\n",
+                elapsed);
+        hpx::util::format_to(std::cout,
+                "Bandwidth == {1} [GB/s]\n",
+                (read + written) * size * sizeof(VALUETYPE) / elapsed / 1e9);
+        hpx::util::format_to(std::cout,
+                "Bandwidth with Write Allocate == {1} [GB/s]\n",
+                (read + written + allocated) * size * sizeof(VALUETYPE) / elapsed / 1e9);
+        hpx::util::format_to(std::cout,
+                "Element Rate == {1} [Gelements/s]\n",
+                size / elapsed / 1e9);
+        hpx::util::format_to(std::cout,
+                "Streaming Stores == {1}\n",
+                stream ? "on" : "off");
+
+        // every locality checks its part of the written vector
+        auto const errors = hpx::count_if(hpx::execution::par, result->begin(),
+            result->end(), [expected](VALUETYPE x) { return x != expected; });
+        hpx::util::format_to(std::cout,
+                "Locality {1} Errors == {2}\n",
+                hpx::get_locality_id(), errors);
+
+        // Wait for all localities to reach this point.
+        latch.arrive_and_wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Expression templates.
+//
+// An element-wise expression over the local parts of vectors is not evaluated
+// when it is written down. Every operator returns a small node which holds
+// its operands, the expression is a tree of nodes whose element i is computed
+// on demand. Assigning the expression to the local part of a vector evaluates
+// the whole tree in one parallel loop, each element is read and written once
+// however many operations the expression chains.
+//
+// The chain benchmark applies chain_length steps to v, cycling through
+// v = v + y, v = v * 0.5, v = clamp(v, 0, 4) and v = v - y. Unfused, every
+// step is an own hpx::transform over the vectors, the steps with y move three
+// vectors and the others two. Fused, the chain is one expression and moves
+// three vectors whatever its length.
+//
+// Situation example (v = 1, y = 2, chain_length = 4):
+// unfused  v = 3, v = 1.5, v = 1.5, v = -0.5   10 vectors moved
+// fused    v = clamp((v + y) * 0.5, 0, 4) - y  3 vectors moved, v = -0.5
+//
+template <typename T>
+struct is_expression : std::false_type
+{
+};
+
+// leaf: the local part of a vector, assigning an expression to it evaluates
+// the expression
+struct vector_expression
+{
+    VALUETYPE* data;
+    std::size_t size;
+
+    vector_expression(VALUETYPE* first, std::size_t count)
+      : data(first)
+      , size(count)
+    {
+    }
+
+    vector_expression(vector_expression const&) = default;
+
+    VALUETYPE operator[](std::size_t i) const
+    {
+        return data[i];
+    }
+
+    template <typename E>
+    vector_expression& operator=(E const& e)
+    {
+        // e is copied into the loop body, it holds pointers only
+        VALUETYPE* out = data;
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), size,
+            [out, e](std::size_t i) { out[i] = e[i]; });
+        return *this;
+    }
+
+    vector_expression& operator=(vector_expression const& e)
+    {
+        return operator=<vector_expression>(e);
+    }
+};
+
+// leaf: a scalar, the same value for every element
+struct scalar_expression
+{
+    VALUETYPE value;
+
+    VALUETYPE operator[](std::size_t) const
+    {
+        return value;
+    }
+};
+
+template <typename Op, typename L, typename R>
+struct binary_expression
+{
+    L left;
+    R right;
+
+    VALUETYPE operator[](std::size_t i) const
+    {
+        return Op()(left[i], right[i]);
+    }
+};
+
+template <typename E>
+struct clamp_expression
+{
+    E operand;
+    VALUETYPE low;
+    VALUETYPE high;
+
+    VALUETYPE operator[](std::size_t i) const
+    {
+        return std::min(std::max(operand[i], low), high);
+    }
+};
+
+template <>
+struct is_expression<vector_expression> : std::true_type
+{
+};
+
+template <>
+struct is_expression<scalar_expression> : std::true_type
+{
+};
+
+template <typename Op, typename L, typename R>
+struct is_expression<binary_expression<Op, L, R>> : std::true_type
+{
+};
+
+template <typename E>
+struct is_expression<clamp_expression<E>> : std::true_type
+{
+};
+
+// the local part of view as expression
+vector_expression lazy(partitioned_vector_view<VALUETYPE>& view)
+{
+    return {&*view.begin(), view.size()};
+}
+
+// scalars become scalar_expression, expressions stay what they are
+inline scalar_expression as_expression(VALUETYPE value)
+{
+    return {value};
+}
+
+template <typename E, typename = std::enable_if_t<is_expression<E>::value>>
+E const& as_expression(E const& e)
+{
+    return e;
+}
+
+template <typename T>
+using expression_t = std::decay_t<decltype(as_expression(std::declval<T const&>()))>;
+
+// an operator applies if one of its operands is an expression
+template <typename L, typename R>
+using enable_if_expression_t = std::enable_if_t<
+    is_expression<L>::value || is_expression<R>::value>;
+
+template <typename L, typename R, typename = enable_if_expression_t<L, R>>
+binary_expression<std::plus<VALUETYPE>, expression_t<L>, expression_t<R>>
+operator+(L const& left, R const& right)
+{
+    return {as_expression(left), as_expression(right)};
+}
+
+template <typename L, typename R, typename = enable_if_expression_t<L, R>>
+binary_expression<std::minus<VALUETYPE>, expression_t<L>, expression_t<R>>
+operator-(L const& left, R const& right)
+{
+    return {as_expression(left), as_expression(right)};
+}
+
+template <typename L, typename R, typename = enable_if_expression_t<L, R>>
+binary_expression<std::multiplies<VALUETYPE>, expression_t<L>, expression_t<R>>
+operator*(L const& left, R const& right)
+{
+    return {as_expression(left), as_expression(right)};
+}
+
+template <typename E, typename = std::enable_if_t<is_expression<E>::value>>
+clamp_expression<E> clamp_to(E const& e, VALUETYPE low, VALUETYPE high)
+{
+    return {e, low, high};
+}
+
+// step k of the chain applied to the expression v
+template <std::size_t K, typename E>
+auto chain_step(E const& v, vector_expression const& y)
+{
+    if constexpr (K % 4 == 0)
+        return v + y;
+    else if constexpr (K % 4 == 1)
+        return v * VALUETYPE(0.5);
+    else if constexpr (K % 4 == 2)
+        return clamp_to(v, VALUETYPE(0), VALUETYPE(4));
+    else
+        return v - y;
+}
+
+// steps k to n - 1 of the chain applied to the expression v
+template <std::size_t K, std::size_t N, typename E>
+auto chain_expression(E const& v, vector_expression const& y)
+{
+    if constexpr (K == N)
+        return v;
+    else
+        return chain_expression<K + 1, N>(chain_step<K>(v, y), y);
+}
+
+// the same step as a separate pass over the vectors
+void run_chain_step(std::size_t k, partitioned_vector_view<VALUETYPE>& view_v,
+    partitioned_vector_view<VALUETYPE>& view_y)
+{
+    switch (k % 4)
+    {
+    case 0:
+        hpx::transform(hpx::execution::par, view_v.begin(), view_v.end(), view_y.begin(),
+            view_v.begin(), [](VALUETYPE v, VALUETYPE y) { return v + y; });
+        break;
+    case 1:
+        hpx::transform(hpx::execution::par, view_v.begin(), view_v.end(), view_v.begin(),
+            [](VALUETYPE v) { return v * VALUETYPE(0.5); });
+        break;
+    case 2:
+        hpx::transform(hpx::execution::par, view_v.begin(), view_v.end(), view_v.begin(),
+            [](VALUETYPE v) { return std::min(std::max(v, VALUETYPE(0)), VALUETYPE(4)); });
+        break;
+    default:
+        hpx::transform(hpx::execution::par, view_v.begin(), view_v.end(), view_y.begin(),
+            view_v.begin(), [](VALUETYPE v, VALUETYPE y) { return v - y; });
+        break;
+    }
+}
+
+// vectors moved by the unfused chain of n steps
+std::size_t chain_vectors_unfused(std::size_t n)
+{
+    std::size_t vectors = 0;
+    for (std::size_t k = 0; k != n; ++k)
+        vectors += (k % 4 == 0 || k % 4 == 3) ? 3 : 2;
+    return vectors;
+}
+
+template <std::size_t N>
+void run_chain_fused(partitioned_vector_view<VALUETYPE>& view_v,
+    partitioned_vector_view<VALUETYPE>& view_y)
+{
+    vector_expression v = lazy(view_v);
+    v = chain_expression<0, N>(v, lazy(view_y));
+}
+
+// one round of the chain of length chain_length, fused or unfused
+void run_chain_round(std::size_t chain_length, bool fused,
+    partitioned_vector_view<VALUETYPE>& view_v, partitioned_vector_view<VALUETYPE>& view_y)
+{
+    if (!fused)
+    {
+        for (std::size_t k = 0; k != chain_length; ++k)
+            run_chain_step(k, view_v, view_y);
+        return;
+    }
+    switch (chain_length)
+    {
+    case 1:
+        run_chain_fused<1>(view_v, view_y);
+        break;
+    case 2:
+        run_chain_fused<2>(view_v, view_y);
+        break;
+    case 4:
+        run_chain_fused<4>(view_v, view_y);
+        break;
+    case 8:
+        run_chain_fused<8>(view_v, view_y);
+        break;
+    default:
+        throw std::invalid_argument(
+            "unsupported chain_length: " + std::to_string(chain_length));
+    }
+}
+
+// Unfused and fused chains of the given lengths over v and y of size elements
+void run_chain(std::size_t size, std::vector<std::size_t> const& chain_lengths,
+    int loop_count, int warmup_loop_count)
+{
+    char const* const vector_name_v = "v_vector";
+    char const* const vector_name_y = "y_vector";
+    char const* const latch_name = "latch";
+
+    {
+        // create vector on one locality, connect to it from all others
+        hpx::partitioned_vector<VALUETYPE> v;
+        hpx::partitioned_vector<VALUETYPE> y;
+        hpx::distributed::latch latch;
+
+        if (0 == hpx::get_locality_id())
+        {
+            std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+            v = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(localities));
+            v.register_as(vector_name_v);
+
+            y = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(localities));
+            y.register_as(vector_name_y);
+
+            latch = hpx::distributed::latch(localities.size());
+            latch.register_as(latch_name);
+        }
+        else
+        {
+            hpx::future<void> f1 = v.connect_to(vector_name_v);
+            hpx::future<void> f2 = y.connect_to(vector_name_y);
+            latch.connect_to(latch_name);
+            f1.get();
+            f2.get();
+        }
+
+        partitioned_vector_view<VALUETYPE> view_v(v);
+        partitioned_vector_view<VALUETYPE> view_y(y);
+        hpx::fill(hpx::execution::par, view_y.begin(), view_y.end(), VALUETYPE(2));
+
+        for (std::size_t chain_length : chain_lengths)
+        {
+            double elapsed[2];
+            std::vector<VALUETYPE> unfused;
+            for (bool fused : {false, true})
+            {
+                // both variants start from v = 1 and run the same rounds
+                hpx::fill(hpx::execution::par, view_v.begin(), view_v.end(), VALUETYPE(1));
+
+                // warm-up cache
+                for (int round = 1; round <= warmup_loop_count; ++round) {
+                    run_chain_round(chain_length, fused, view_v, view_y);
+                }
+
+                //start timer
+                hpx::chrono::high_resolution_timer t;
+                for (int round = 1; round <= loop_count; ++round) {
+                    run_chain_round(chain_length, fused, view_v, view_y);
+                }
+                //end timer
+                elapsed[fused] = t.elapsed() / loop_count;
+                if (!fused)
+                    unfused.assign(view_v.begin(), view_v.end());
+            }
+
+            // both variants have to compute the same values
+            auto const differences = std::inner_product(unfused.begin(), unfused.end(),
+                view_v.begin(), std::size_t(0), std::plus<std::size_t>(),
+                [](VALUETYPE a, VALUETYPE b) { return std::size_t(a != b); });
+
+            std::size_t const vectors_unfused = chain_vectors_unfused(chain_length);
+            std::size_t const vectors_fused = 3;
+            hpx::util::format_to(std::cout,
+                    "Chain Length == {1}\n",
+                    chain_length);
+            hpx::util::format_to(std::cout,
+                    "Unfused Elapsed Time == {1} [s]\n",
+                    elapsed[0]);
+            hpx::util::format_to(std::cout,
+                    "Fused Elapsed Time == {1} [s]\n",
+                    elapsed[1]);
+            hpx::util::format_to(std::cout,
+                    "Unfused Bandwidth == {1} [GB/s]\n",
+                    vectors_unfused * size * sizeof(VALUETYPE) / elapsed[0] / 1e9);
+            hpx::util::format_to(std::cout,
+                    "Fused Bandwidth == {1} [GB/s]\n",
+                    vectors_fused * size * sizeof(VALUETYPE) / elapsed[1] / 1e9);
+            hpx::util::format_to(std::cout,
+                    "Unfused Element Rate == {1} [Gelements/s]\n",
+                    size / elapsed[0] / 1e9);
+            hpx::util::format_to(std::cout,
+                    "Fused Element Rate == {1} [Gelements/s]\n",
+                    size / elapsed[1] / 1e9);
+            hpx::util::format_to(std::cout,
+                    "Bytes Saved == {1} [%]\n",
+                    100.0 * (vectors_unfused - vectors_fused) / vectors_unfused);
+            hpx::util::format_to(std::cout,
+                    "Speedup == {1}\n",
+                    elapsed[0] / elapsed[1]);
+            hpx::util::format_to(std::cout,
+                    "Locality {1} Differences == {2}\n",
+                    hpx::get_locality_id(), differences);
+        }
+
+        // Wait for all localities to reach this point.
+        latch.arrive_and_wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Gather and scatter.
+//
+// Indexed transforms over v, y and out of VALUETYPE and an index vector idx
+// of the local size:
+// gather:  out[i] = v[idx[i]] + y[i]
+// scatter: out[idx[i]] = v[i] + y[i]
+//
+// idx is a permutation of the local positions, so the scatter writes every
+// element once. The index patterns are
+// sequential:   idx[i] = i
+// strided:      every index_stride-th position, then the same shifted by one
+// block_random: blocks of index_block positions in random order
+// random:       a random permutation
+//
+// With index_scope local the indices address the local parts only. With
+// index_scope global the element i of locality l addresses the position
+// idx[i] of the partition (l + s(i)) % localities, which is read with
+// get_values and written with set_values of the partitioned vector if it is
+// remote. s(i) is i * localities / size for sequential (every locality
+// exchanges a contiguous chunk with every other one), i % localities for
+// strided, random per block for block_random and random per element for
+// random. s(i) is the same on all localities, so the global mapping is a
+// permutation as well. index_scope global requires partitions of the same
+// size.
+//
+// Situation example (gather, local size 4, 2 localities, strided with
+// index_stride 2):
+// idx 0 2 1 3, s 0 1 0 1
+// L0 out[0..3] = v(L0)[0] v(L1)[2] v(L0)[1] v(L1)[3] + y
+// L1 out[0..3] = v(L1)[0] v(L0)[2] v(L1)[1] v(L0)[3] + y
+//
+// Effective Bandwidth counts the index, v, y and out once per element, the
+// cache lines which are transferred for the scattered accesses can be
+// several times more.
+//
+enum class index_pattern
+{
+    sequential,
+    strided,
+    block_random,
+    random
+};
+
+index_pattern parse_index_pattern(std::string const& name)
+{
+    if (name == "sequential")
+        return index_pattern::sequential;
+    if (name == "strided")
+        return index_pattern::strided;
+    if (name == "block_random")
+        return index_pattern::block_random;
+    if (name == "random")
+        return index_pattern::random;
+    throw std::invalid_argument("unknown index_pattern: " + name);
+}
+
+enum class index_scope
+{
+    local,
+    global
+};
+
+index_scope parse_index_scope(std::string const& name)
+{
+    if (name == "local")
+        return index_scope::local;
+    if (name == "global")
+        return index_scope::global;
+    throw std::invalid_argument("unknown index_scope: " + name);
+}
+
+// the permutation idx of count positions, the same on all localities
+std::vector<std::size_t> make_indices(index_pattern pattern, std::size_t count,
+    std::size_t stride, std::size_t block)
+{
+    std::vector<std::size_t> indices(count);
+    std::mt19937_64 gen(42);
+    switch (pattern)
+    {
+    case index_pattern::sequential:
+        std::iota(indices.begin(), indices.end(), std::size_t(0));
+        break;
+    case index_pattern::strided:
+    {
+        std::size_t pos = 0;
+        for (std::size_t first = 0; first != stride && first < count; ++first)
+            for (std::size_t i = first; i < count; i += stride)
+                indices[pos++] = i;
+        break;
+    }
+    case index_pattern::block_random:
+    {
+        // the positions behind the last full block stay in place
+        std::vector<std::size_t> blocks(count / block);
+        std::iota(blocks.begin(), blocks.end(), std::size_t(0));
+        std::shuffle(blocks.begin(), blocks.end(), gen);
+        for (std::size_t b = 0; b != blocks.size(); ++b)
+            std::iota(indices.begin() + b * block, indices.begin() + (b + 1) * block,
+                blocks[b] * block);
+        std::iota(indices.begin() + blocks.size() * block, indices.end(),
+            blocks.size() * block);
+        break;
+    }
+    case index_pattern::random:
+    default:
+        std::iota(indices.begin(), indices.end(), std::size_t(0));
+        std::shuffle(indices.begin(), indices.end(), gen);
+        break;
+    }
+    return indices;
+}
+
+// the partition shift s(i) of index_scope global, the same on all localities
+std::vector<std::size_t> make_shifts(index_pattern pattern, std::size_t count,
+    std::size_t localities, std::size_t block)
+{
+    std::vector<std::size_t> shifts(count);
+    std::mt19937_64 gen(4711);
+    std::uniform_int_distribution<std::size_t> dist(0, localities - 1);
+    std::size_t shift = 0;
+    for (std::size_t i = 0; i != count; ++i)
+    {
+        switch (pattern)
+        {
+        case index_pattern::sequential:
+            shift = i * localities / count;
+            break;
+        case index_pattern::strided:
+            shift = i % localities;
+            break;
+        case index_pattern::block_random:
+            if (i % block == 0)
+                shift = dist(gen);
+            break;
+        case index_pattern::random:
+        default:
+            shift = dist(gen);
+            break;
+        }
+        shifts[i] = shift;
+    }
+    return shifts;
+}
+
+// v[g] of the global position g, exact in VALUETYPE
+inline VALUETYPE indirect_value(std::size_t g)
+{
+    return VALUETYPE(g % 1024);
+}
+
+// Gather or scatter of size elements with the given index pattern and scope
+void run_indirect(std::size_t size, transform_kernel kernel, index_pattern pattern,
+    index_scope scope, std::size_t stride, std::size_t block, int loop_count,
+    int warmup_loop_count)
+{
+    char const* const vector_name_v = "v_vector";
+    char const* const vector_name_y = "y_vector";
+    char const* const vector_name_out = "out_vector";
+
+    bool const gather = kernel == transform_kernel::gather;
+    std::size_t const localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const here = hpx::get_locality_id();
+
+    if (scope == index_scope::global && size % localities != 0)
+    {
+        throw std::invalid_argument(
+            "index_scope global requires a size divisible by the number of localities");
+    }
+
+    {
+        // create vector on one locality, connect to it from all others
+        hpx::partitioned_vector<VALUETYPE> v;
+        hpx::partitioned_vector<VALUETYPE> y;
+        hpx::partitioned_vector<VALUETYPE> out;
+
+        if (0 == here)
+        {
+            std::vector<hpx::id_type> all_localities = hpx::find_all_localities();
+
+            v = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(all_localities));
+            v.register_as(vector_name_v);
+
+            y = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(all_localities));
+            y.register_as(vector_name_y);
+
+            out = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(all_localities));
+            out.register_as(vector_name_out);
+        }
+        else
+        {
+            hpx::future<void> f1 = v.connect_to(vector_name_v);
+            hpx::future<void> f2 = y.connect_to(vector_name_y);
+            hpx::future<void> f3 = out.connect_to(vector_name_out);
+            f1.get();
+            f2.get();
+            f3.get();
+        }
+
+        partitioned_vector_view<VALUETYPE> view_v(v);
+        partitioned_vector_view<VALUETYPE> view_y(y);
+        partitioned_vector_view<VALUETYPE> view_out(out);
+        std::size_t const count = view_v.size();
+
+        // v holds its global position, y = 1 and out = -1 marks the elements
+        // which are not written yet
+        VALUETYPE* const local_v = &*view_v.begin();
+        VALUETYPE* const local_y = &*view_y.begin();
+        VALUETYPE* const local_out = &*view_out.begin();
+        std::size_t const offset = here * count;
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), count,
+            [=](std::size_t i) { local_v[i] = indirect_value(offset + i); });
+        hpx::fill(hpx::execution::par, view_y.begin(), view_y.end(), VALUETYPE(1));
+        hpx::fill(hpx::execution::par, view_out.begin(), view_out.end(), VALUETYPE(-1));
+
+        std::vector<std::size_t> const indices = make_indices(pattern, count, stride, block);
+
+        // index_scope global: the positions in and the local elements for
+        // every partition
+        std::vector<std::vector<std::size_t>> positions;
+        std::vector<std::vector<std::size_t>> elements;
+        std::vector<std::size_t> shifts;
+        std::size_t remote = 0;
+        if (scope == index_scope::global)
+        {
+            shifts = make_shifts(pattern, count, localities, block);
+            positions.resize(localities);
+            elements.resize(localities);
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                std::size_t const part = (here + shifts[i]) % localities;
+                positions[part].push_back(indices[i]);
+                elements[part].push_back(i);
+            }
+            remote = count - positions[here].size();
+        }
+        hpx::distributed::barrier::synchronize();
+
+        auto indirect_round = [&]() {
+            std::size_t const* const idx = indices.data();
+            if (scope == index_scope::local)
+            {
+                if (gather)
+                    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), count,
+                        [=](std::size_t i) { local_out[i] = local_v[idx[i]] + local_y[i]; });
+                else
+                    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), count,
+                        [=](std::size_t i) { local_out[idx[i]] = local_v[i] + local_y[i]; });
+                return;
+            }
+
+            std::vector<std::size_t> const& local_positions = positions[here];
+            std::vector<std::size_t> const& local_elements = elements[here];
+            if (gather)
+            {
+                // request the remote values first, gather the local ones while
+                // they are on their way
+                std::vector<hpx::future<std::vector<VALUETYPE>>> values(localities);
+                for (std::size_t part = 0; part != localities; ++part)
+                {
+                    if (part != here)
+                        values[part] = v.get_values(part, positions[part]);
+                }
+                hpx::experimental::for_loop(hpx::execution::par, std::size_t(0),
+                    local_elements.size(), [&](std::size_t k) {
+                        std::size_t const i = local_elements[k];
+                        local_out[i] = local_v[local_positions[k]] + local_y[i];
+                    });
+                for (std::size_t part = 0; part != localities; ++part)
+                {
+                    if (part == here)
+                        continue;
+                    std::vector<VALUETYPE> const received = values[part].get();
+                    std::vector<std::size_t> const& part_elements = elements[part];
+                    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0),
+                        part_elements.size(), [&](std::size_t k) {
+                            std::size_t const i = part_elements[k];
+                            local_out[i] = received[k] + local_y[i];
+                        });
+                }
+            }
+            else
+            {
+                std::vector<hpx::future<void>> sent;
+                for (std::size_t part = 0; part != localities; ++part)
+                {
+                    if (part == here)
+                        continue;
+                    std::vector<std::size_t> const& part_elements = elements[part];
+                    std::vector<VALUETYPE> values(part_elements.size());
+                    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0),
+                        part_elements.size(), [&](std::size_t k) {
+                            std::size_t const i = part_elements[k];
+                            values[k] = local_v[i] + local_y[i];
+                        });
+                    sent.push_back(out.set_values(part, positions[part], values));
+                }
+                hpx::experimental::for_loop(hpx::execution::par, std::size_t(0),
+                    local_elements.size(), [&](std::size_t k) {
+                        std::size_t const i = local_elements[k];
+                        local_out[local_positions[k]] = local_v[i] + local_y[i];
+                    });
+                hpx::wait_all(sent);
+            }
+        };
+
+        // warm-up cache
+        for (int round = 1; round <= warmup_loop_count; ++round) {
+            indirect_round();
+        }
+
+        //start timer
+        hpx::chrono::high_resolution_timer t;
+        for (int round = 1; round <= loop_count; ++round) {
+            indirect_round();
+        }
+        //end timer
+        double elapsed = t.elapsed() / loop_count;
+
+        // the scatter of the other localities has to be complete
+        hpx::distributed::barrier::synchronize();
+
+        std::size_t const bytes = sizeof(std::size_t) + 3 * sizeof(VALUETYPE);
+        hpx::util::format_to(std::cout,
+                "Elapsed Time == {1} [s]\n",
+                elapsed);
+        hpx::util::format_to(std::cout,
+                "Time per Element == {1} [ns]\n",
+                elapsed / count * 1e9);
+        hpx::util::format_to(std::cout,
+                "Effective Bandwidth == {1} [GB/s]\n",
+                bytes * count / elapsed / 1e9);
+        hpx::util::format_to(std::cout,
+                "Remote Fraction == {1}\n",
+                double(remote) / count);
+
+        // every locality checks its part of out, a gathered element against
+        // the value of its source, a scattered one for being written
+        std::size_t errors = 0;
+        if (gather)
+        {
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                std::size_t source = offset + indices[i];
+                if (scope == index_scope::global)
+                    source = (here + shifts[i]) % localities * count + indices[i];
+                errors += local_out[i] != indirect_value(source) + 1;
+            }
+        }
+        else
+        {
+            errors = std::count(view_out.begin(), view_out.end(), VALUETYPE(-1));
+        }
+        hpx::util::format_to(std::cout,
+                "Locality {1} Errors == {2}\n",
+                here, errors);
+
+        hpx::distributed::barrier::synchronize();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Arithmetic intensity.
+//
+// v[i] = f(v[i]) with f a chain of Fmas multiply-adds x = x * a + b. Every
+// element is read and written once (8 bytes for float) and costs 2 * Fmas
+// flops, the arithmetic intensity is Fmas / 4 flop/byte. Fmas is a template
+// parameter. With few Fmas the kernel is bound by the memory bandwidth, with
+// many by the floating point throughput of the cores (the roofline, see
+// plots/roofline.py). The HPX build sets no -march, so the compiler emits a
+// multiply and an add per step unless the flags of the HPX installation
+// target FMA instructions; the flop count is the same either way.
+//
+// The chain of a single element is bound by the latency of the multiply-add,
+// not by its throughput. fma_chains therefore updates blocks of fma_block
+// elements with fma_chain_count independent chains per SIMD lane, enough to
+// cover the latency (4 to 5 cycles) times the pipes (2) of the cores.
+//
+// The compute roof is measured by the peak kernel: every worker thread runs
+// fma_chains with fma_peak_fmas multiply-adds on a block in its registers,
+// without any memory traffic. It is printed as Peak Performance after the
+// sweep.
+//
+// a = b = 0.5 keep v = 1 exact, so the result can be checked after any
+// number of rounds.
+//
+// Situation example (Fmas 4):
+// 8 flops per element, 8 bytes per element, 1 flop/byte
+//
+constexpr std::size_t fma_chain_count = 10;
+constexpr std::size_t fma_width = 16;
+constexpr std::size_t fma_block = fma_chain_count * fma_width;
+constexpr int fma_peak_fmas = 1 << 16;
+
+template <int Fmas>
+VALUETYPE fma_chain(VALUETYPE x, VALUETYPE a, VALUETYPE b)
+{
+    for (int k = 0; k != Fmas; ++k)
+        x = x * a + b;
+    return x;
+}
+
+// the chains of the fma_block elements starting at x, chain c of lane l is
+// x[l + c * fma_width]
+template <int Fmas>
+void fma_chains(VALUETYPE* x, VALUETYPE a, VALUETYPE b)
+{
+    for (std::size_t l = 0; l != fma_width; ++l)
+    {
+        VALUETYPE v[fma_chain_count];
+        for (std::size_t c = 0; c != fma_chain_count; ++c)
+            v[c] = x[l + c * fma_width];
+        for (int k = 0; k != Fmas; ++k)
+        {
+            for (std::size_t c = 0; c != fma_chain_count; ++c)
+                v[c] = v[c] * a + b;
+        }
+        for (std::size_t c = 0; c != fma_chain_count; ++c)
+            x[l + c * fma_width] = v[c];
+    }
+}
+
+template <int Fmas>
+double run_fma_rounds(partitioned_vector_view<VALUETYPE>& view_v, VALUETYPE a,
+    VALUETYPE b, int loop_count, int warmup_loop_count)
+{
+    VALUETYPE* const first = &*view_v.begin();
+    std::size_t const count = view_v.size();
+    std::size_t const blocks = count / fma_block;
+
+    auto fma_round = [&]() {
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), blocks,
+            [=](std::size_t k) { fma_chains<Fmas>(first + k * fma_block, a, b); });
+        for (std::size_t i = blocks * fma_block; i != count; ++i)
+            first[i] = fma_chain<Fmas>(first[i], a, b);
+    };
+
+    // warm-up cache
+    for (int round = 1; round <= warmup_loop_count; ++round) {
+        fma_round();
+    }
+
+    //start timer
+    hpx::chrono::high_resolution_timer t;
+    for (int round = 1; round <= loop_count; ++round) {
+        fma_round();
+    }
+    //end timer
+    return t.elapsed() / loop_count;
+}
+
+// time of the peak kernel on all worker threads, returns the errors (blocks
+// which do not end up at 1)
+std::size_t run_fma_peak_rounds(VALUETYPE a, VALUETYPE b, int loop_count,
+    int warmup_loop_count, double& elapsed)
+{
+    std::size_t const num_workers = hpx::get_num_worker_threads();
+    std::vector<std::size_t> errors(num_workers, 0);
+
+    auto peak_round = [&]() {
+        hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), num_workers,
+            [&](std::size_t k) {
+                alignas(64) VALUETYPE x[fma_block];
+                std::fill(x, x + fma_block, VALUETYPE(1));
+                fma_chains<fma_peak_fmas>(x, a, b);
+                errors[k] += std::count_if(x, x + fma_block,
+                    [](VALUETYPE y) { return y != VALUETYPE(1); });
+            });
+    };
+
+    // warm-up
+    for (int round = 1; round <= warmup_loop_count; ++round) {
+        peak_round();
+    }
+
+    //start timer
+    hpx::chrono::high_resolution_timer t;
+    for (int round = 1; round <= loop_count; ++round) {
+        peak_round();
+    }
+    //end timer
+    elapsed = t.elapsed() / loop_count;
+    return std::accumulate(errors.begin(), errors.end(), std::size_t(0));
+}
+
+// The FMA chain kernel over v of size elements for every count of
+// multiply-adds per element
+void run_fma(std::size_t size, std::vector<int> const& fma_counts, int loop_count,
+    int warmup_loop_count, VALUETYPE a, VALUETYPE b)
+{
+    char const* const vector_name_v = "v_vector";
+    char const* const latch_name = "latch";
+
+    {
+        // create vector on one locality, connect to it from all others
+        hpx::partitioned_vector<VALUETYPE> v;
+        hpx::distributed::latch latch;
+
+        if (0 == hpx::get_locality_id())
+        {
+            std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+            v = hpx::partitioned_vector<VALUETYPE>(
+                size, hpx::container_layout(localities));
+            v.register_as(vector_name_v);
+
+            latch = hpx::distributed::latch(localities.size());
+            latch.register_as(latch_name);
+        }
+        else
+        {
+            hpx::future<void> f1 = v.connect_to(vector_name_v);
+            latch.connect_to(latch_name);
+            f1.get();
+        }
+
+        partitioned_vector_view<VALUETYPE> view_v(v);
+        hpx::fill(hpx::execution::par, view_v.begin(), view_v.end(), VALUETYPE(1));
+
+        for (int fmas : fma_counts)
+        {
+            double elapsed = 0;
+            switch (fmas)
+            {
+            case 1:
+                elapsed = run_fma_rounds<1>(view_v, a, b, loop_count, warmup_loop_count);
+                break;
+            case 2:
+                elapsed = run_fma_rounds<2>(view_v, a, b, loop_count, warmup_loop_count);
+                break;
+            case 4:
+                elapsed = run_fma_rounds<4>(view_v, a, b, loop_count, warmup_loop_count);
+                break;
+            case 8:
+                elapsed = run_fma_rounds<8>(view_v, a, b, loop_count, warmup_loop_count);
+                break;
+            case 16:
+                elapsed = run_fma_rounds<16>(view_v, a, b, loop_count, warmup_loop_count);
+                break;
+            case 32:
+                elapsed = run_fma_rounds<32>(view_v, a, b, loop_count, warmup_loop_count);
+                break;
+            case 64:
+                elapsed = run_fma_rounds<64>(view_v, a, b, loop_count, warmup_loop_count);
+                break;
+            case 128:
+                elapsed = run_fma_rounds<128>(view_v, a, b, loop_count, warmup_loop_count);
+                break;
+            case 256:
+                elapsed = run_fma_rounds<256>(view_v, a, b, loop_count, warmup_loop_count);
+                break;
+            default:
+                throw std::invalid_argument("unsupported fma_count: " + std::to_string(fmas));
+            }
+
+            double const flops = 2.0 * fmas * size;
+            double const bytes = 2.0 * size * sizeof(VALUETYPE);
+            hpx::util::format_to(std::cout,
+                    "FMA Count == {1}\n",
+                    fmas);
+            hpx::util::format_to(std::cout,
+                    "Elapsed Time == {1} [s]\n",
+                    elapsed);
+            hpx::util::format_to(std::cout,
+                    "Arithmetic Intensity == {1} [flop/byte]\n",
+                    flops / bytes);
+            hpx::util::format_to(std::cout,
+                    "Performance == {1} [GFLOP/s]\n",
+                    flops / elapsed / 1e9);
+            hpx::util::format_to(std::cout,
+                    "Bandwidth == {1} [GB/s]\n",
+                    bytes / elapsed / 1e9);
+        }
+
+        // compute roof of the locality
+        double peak_elapsed = 0;
+        std::size_t const peak_errors =
+            run_fma_peak_rounds(a, b, loop_count, warmup_loop_count, peak_elapsed);
+        double const peak_flops =
+            2.0 * fma_peak_fmas * fma_block * hpx::get_num_worker_threads();
+        hpx::util::format_to(std::cout,
+                "Peak Performance == {1} [GFLOP/s]\n",
+                peak_flops / peak_elapsed / 1e9);
+
+        // every locality checks its part of v and the blocks of the peak kernel
+        auto const errors = hpx::count_if(hpx::execution::par, view_v.begin(),
+            view_v.end(), [](VALUETYPE x) { return x != VALUETYPE(1); });
+        hpx::util::format_to(std::cout,
+                "Locality {1} Errors == {2}\n",
+                hpx::get_locality_id(), errors + peak_errors);
+
+        // Wait for all localities to reach this point.
+        latch.arrive_and_wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Compressed storage.
+//
+// The vector y holds 32 bit unsigned integers compressed in blocks of
+// numa::block_size values, stored as a partitioned_vector of 32 bit words.
+// The formats and the block layout are those of include/compressed.hpp: a
+// block is decoded row by row and every row is added to the matching row of v
+// while it is still in registers, the decoded values never go to memory. The
+// compressed formats read fewer bytes per element, so the elements per second
+// of the memory bound transform grow with the compression ratio as long as
+// decoding keeps up with the memory.
+//
+// uint32:    the values uncompressed, the baseline
+// bitpacked: the values with Bits bits each
+// delta_for: delta plus frame of reference with Bits bits per entry
+//
+// The transform is v = v + y with v float, y is read and v is read and
+// written. The values of y are the example blocks of the format, generated
+// from the global block index.
+//
+// Situation example (delta_for, blocks of 3 rows of 2 lanes):
+// rows      (100 104) (102 107) (105 109)
+// header    base (100 104)   reference (2 2)
+// entries   row 1 (0 1)   row 2 (1 0)
+//
+enum class compression_format
+{
+    uint32,
+    bitpacked,
+    delta_for
+};
+
+compression_format parse_compression_format(std::string const& name)
+{
+    if (name == "uint32")
+        return compression_format::uint32;
+    if (name == "bitpacked")
+        return compression_format::bitpacked;
+    if (name == "delta_for")
+        return compression_format::delta_for;
+    throw std::invalid_argument("unknown compression format: " + name);
+}
+
+template <int Bits, typename F>
+void with_compressed_bits(compression_format format, F&& f)
+{
+    if (format == compression_format::bitpacked)
+        f(bitpacked_format<Bits>());
+    else
+        f(delta_for_format<Bits>());
+}
+
+// Calls f with the format object of format and bits, the compressed formats
+// are instantiated for 4, 8, 12, 16 and 24 bits.
+template <typename F>
+void with_compression_format(compression_format format, int bits, F&& f)
+{
+    if (format == compression_format::uint32)
+    {
+        f(uncompressed_format());
+        return;
+    }
+    switch (bits)
+    {
+    case 4:
+        with_compressed_bits<4>(format, f);
+        break;
+    case 8:
+        with_compressed_bits<8>(format, f);
+        break;
+    case 12:
+        with_compressed_bits<12>(format, f);
+        break;
+    case 16:
+        with_compressed_bits<16>(format, f);
+        break;
+    case 24:
+        with_compressed_bits<24>(format, f);
+        break;
+    default:
+        throw std::invalid_argument(
+            "compressed_bits has to be 4, 8, 12, 16 or 24: " + std::to_string(bits));
+    }
+}
+
+// Number of blocks per locality for size values, the blocks do not straddle
+// partitions.
+inline std::size_t compressed_local_blocks(std::size_t size, std::size_t num_localities)
+{
+    std::size_t const per_locality = num_localities * numa::block_size;
+    return (std::max)(std::size_t(1), (size + per_locality - 1) / per_locality);
+}
+
+// v = v + y over block b of the local part of v, the block of y is decoded
+// row by row into the rows of v
+template <typename Format>
+void compressed_add_block(VALUETYPE* v, compressed_word const* words, std::size_t b)
+{
+    VALUETYPE* const block = v + b * numa::block_size;
+    Format::decode(words + b * Format::block_words,
+        [block](std::size_t k, std::uint32_t const* row) {
+            VALUETYPE* const out = block + k * numa::block_lanes;
+            for (std::size_t l = 0; l != numa::block_lanes; ++l)
+            {
+                out[l] += static_cast<VALUETYPE>(row[l]);
+            }
+        });
+}
+
+// The transform v = v + y over size elements (rounded up to whole blocks on
+// every locality) with y in format, for every bit count of bit_counts. The
+// vector y has the size of the uncompressed values, a format uses the front
+// of every partition. v starts at 0 for every bit count, every locality
+// checks its part of v against the same float additions of the values.
+void run_compressed_transform(std::size_t size, compression_format format,
+    std::vector<int> const& bit_counts, int loop_count, int warmup_loop_count)
+{
+    char const* const vector_name_v = "v_vector";
+    char const* const vector_name_y = "y_vector";
+    char const* const latch_name = "latch";
+
+    std::size_t const num_localities = hpx::get_num_localities(hpx::launch::sync);
+    std::size_t const local_blocks = compressed_local_blocks(size, num_localities);
+    std::size_t const elements = num_localities * local_blocks * numa::block_size;
+
+    {
+        // create vector on one locality, connect to it from all others
+        hpx::partitioned_vector<VALUETYPE> v;
+        hpx::partitioned_vector<compressed_word> y;
+        hpx::distributed::latch latch;
+
+        if (0 == hpx::get_locality_id())
+        {
+            std::vector<hpx::id_type> localities = hpx::find_all_localities();
+
+            v = hpx::partitioned_vector<VALUETYPE>(
+                elements, hpx::container_layout(localities));
+            v.register_as(vector_name_v);
+
+            y = hpx::partitioned_vector<compressed_word>(
+                elements, hpx::container_layout(localities));
+            y.register_as(vector_name_y);
+
+            latch = hpx::distributed::latch(localities.size());
+            latch.register_as(latch_name);
+        }
+        else
+        {
+            hpx::future<void> f1 = v.connect_to(vector_name_v);
+            hpx::future<void> f2 = y.connect_to(vector_name_y);
+            latch.connect_to(latch_name);
+            f1.get();
+            f2.get();
+        }
+
+        partitioned_vector_view<VALUETYPE> view_v(v);
+        partitioned_vector_view<compressed_word> view_y(y);
+        VALUETYPE* const local_v = &*view_v.begin();
+        compressed_word* const words = &*view_y.begin();
+        std::size_t const first_block = hpx::get_locality_id() * local_blocks;
+
+        for (int bits : bit_counts)
+        {
+            with_compression_format(format, bits, [&](auto format_type) {
+                using format_t = decltype(format_type);
+
+                // encode the local blocks of y
+                hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), local_blocks,
+                    [&](std::size_t b) {
+                        std::uint32_t values[numa::block_size];
+                        format_t::example_block(first_block + b, values);
+                        format_t::encode(values, words + b * format_t::block_words);
+                    });
+                hpx::fill(hpx::execution::par, view_v.begin(), view_v.end(), VALUETYPE(0));
+
+                auto transform_round = [&]() {
+                    hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), local_blocks,
+                        [&](std::size_t b) { compressed_add_block<format_t>(local_v, words, b); });
+                };
+
+                // warm-up cache
+                for (int round = 1; round <= warmup_loop_count; ++round) {
+                    transform_round();
+                }
+
+                //start timer
+                hpx::chrono::high_resolution_timer t;
+                for (int round = 1; round <= loop_count; ++round) {
+                    transform_round();
+                }
+                //end timer
+                double elapsed = t.elapsed() / loop_count;
+
+                // y is read, v is read and written
+                double const bytes = double(elements) * format_t::block_words /
+                        numa::block_size * sizeof(compressed_word) +
+                    2.0 * elements * sizeof(VALUETYPE);
+                hpx::util::format_to(std::cout,
+                        "Compressed Bits == {1}\n",
+                        format_t::bits);
+                hpx::util::format_to(std::cout,
+                        "Elapsed Time == {1} [s]\n",
+                        elapsed);
+                hpx::util::format_to(std::cout,
+                        "Bandwidth == {1} [GB/s]\n",
+                        bytes / elapsed / 1e9);
+                hpx::util::format_to(std::cout,
+                        "Element Rate == {1} [Gelements/s]\n",
+                        elements / elapsed / 1e9);
+                hpx::util::format_to(std::cout,
+                        "Compression Ratio == {1}\n",
+                        double(numa::block_size) / format_t::block_words);
+
+                // every locality checks its part of v
+                int const rounds = warmup_loop_count + loop_count;
+                std::vector<std::size_t> block_errors(local_blocks);
+                hpx::experimental::for_loop(hpx::execution::par, std::size_t(0), local_blocks,
+                    [&](std::size_t b) {
+                        std::uint32_t values[numa::block_size];
+                        format_t::example_block(first_block + b, values);
+                        for (std::size_t i = 0; i != numa::block_size; ++i)
+                        {
+                            VALUETYPE expected = 0;
+                            for (int round = 0; round != rounds; ++round)
+                                expected += static_cast<VALUETYPE>(values[i]);
+                            block_errors[b] += local_v[b * numa::block_size + i] != expected;
+                        }
+                    });
+                hpx::util::format_to(std::cout,
+                        "Locality {1} Errors == {2}\n",
+                        hpx::get_locality_id(),
+                        std::accumulate(block_errors.begin(), block_errors.end(), std::size_t(0)));
+            });
+        }
+
+        // Wait for all localities to reach this point.
+        latch.arrive_and_wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int hpx_main(hpx::program_options::variables_map& vm)
+{
+    VALUETYPE size = vm["maxelems"].as<VALUETYPE>();
+    int loop_count = vm["loop_count"].as<int>();
+    int warmup_loop_count = vm["warmup_loop_count"].as<int>();
+    std::string const storage = vm["storage"].as<std::string>();
+    transform_kernel kernel = parse_transform_kernel(vm["transform_kernel"].as<std::string>());
+    streaming_stores streaming = parse_streaming_stores(vm["streaming_stores"].as<std::string>());
+    std::size_t const threshold = vm["streaming_threshold"].as<std::size_t>();
+    std::size_t const chain_length = vm["chain_length"].as<std::size_t>();
+    index_pattern pattern = parse_index_pattern(vm["index_pattern"].as<std::string>());
+    index_scope scope = parse_index_scope(vm["index_scope"].as<std::string>());
+    std::size_t const index_stride = vm["index_stride"].as<std::size_t>();
+    std::size_t const index_block = vm["index_block"].as<std::size_t>();
+    int const fma_count = vm["fma_count"].as<int>();
+    int const compressed_bits = vm["compressed_bits"].as<int>();
+    if (kernel != transform_kernel::inplace && storage != "float")
+    {
+        throw std::invalid_argument("the STREAM, chain, gather, scatter and fma kernels support the float storage only");
+    }
+    if (index_stride == 0 || index_block == 0)
+    {
+        throw std::invalid_argument("index_stride and index_block have to be positive");
+    }
+
+    // chain_length 0 sweeps the chains of 1, 2, 4 and 8 steps
+    std::vector<std::size_t> chain_lengths = {chain_length};
+    if (chain_length == 0)
+        chain_lengths = {1, 2, 4, 8};
+
+    // fma_count 0 sweeps 1, 2, 4, ... 256 multiply-adds per element
+    std::vector<int> fma_counts = {fma_count};
+    if (fma_count == 0)
+        fma_counts = {1, 2, 4, 8, 16, 32, 64, 128, 256};
+    
+    // compressed_bits 0 sweeps the compressed formats with 4, 8, 12, 16 and
+    // 24 bits, the uncompressed uint32 storage has 32 bits
+    std::vector<int> bit_counts = {compressed_bits};
+    if (storage == "uint32")
+        bit_counts = {32};
+    else if (compressed_bits == 0)
+        bit_counts = {4, 8, 12, 16, 24};
+    
+    //print vector size
+    if (0 == hpx::get_locality_id())
+    {
+        hpx::cout << "Transform Vector Size: " << size << "\n" << std::flush;
+        hpx::cout << "Transform Kernel: " << vm["transform_kernel"].as<std::string>() << "\n" << std::flush;
+        hpx::cout << "Storage: " << storage << "\n" << std::flush;
+        hpx::cout << "Streaming Stores: " << vm["streaming_stores"].as<std::string>() << "\n" << std::flush;
+        if (kernel == transform_kernel::gather || kernel == transform_kernel::scatter)
+        {
+            hpx::cout << "Index Pattern: " << vm["index_pattern"].as<std::string>() << "\n" << std::flush;
+            hpx::cout << "Index Scope: " << vm["index_scope"].as<std::string>() << "\n" << std::flush;
+        }
+    }
+
+    std::size_t const elements = static_cast<std::size_t>(size);
+    if (kernel == transform_kernel::chain)
+        run_chain(elements, chain_lengths, loop_count, warmup_loop_count);
+    else if (kernel == transform_kernel::fma)
+        run_fma(elements, fma_counts, loop_count, warmup_loop_count,
+            VALUETYPE(0.5), VALUETYPE(0.5));
+    else if (kernel == transform_kernel::gather || kernel == transform_kernel::scatter)
+        run_indirect(elements, kernel, pattern, scope, index_stride, index_block,
+            loop_count, warmup_loop_count);
+    else if (kernel != transform_kernel::inplace)
+        run_stream(elements, kernel, loop_count, warmup_loop_count, streaming, threshold);
+    else if (storage == "float")
+        run_transform<VALUETYPE>(elements, loop_count, warmup_loop_count, streaming, threshold);
+    else if (storage == "bf16")
+        run_transform<bfloat16>(elements, loop_count, warmup_loop_count, streaming, threshold);
+    else if (storage == "fp16")
+        run_transform<float16>(elements, loop_count, warmup_loop_count, streaming, threshold);
+    else if (storage == "int16")
+        run_transform<int16_scaled>(elements, loop_count, warmup_loop_count, streaming, threshold);
+    else if (storage == "int8")
+        run_transform<int8_scaled>(elements, loop_count, warmup_loop_count, streaming, threshold);
+    else if (storage == "uint32" || storage == "bitpacked" || storage == "delta_for")
+        run_compressed_transform(elements, parse_compression_format(storage), bit_counts,
+            loop_count, warmup_loop_count);
+    else
+        throw std::invalid_argument("unknown storage: " + storage);
+
+    return hpx::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    // add command line option which controls the random number generator seed
+    using namespace hpx::program_options;
+    options_description desc_commandline(
+        "Usage: " HPX_APPLICATION_STRING " [options]");
+
+    desc_commandline.add_options()
+        ("maxelems,m",
+         value<VALUETYPE>()->default_value(1024)
+         ,"size of the vector")
+    
+        ("loop_count"
+        , hpx::program_options::value<int>()->default_value(10)
+        , "number of rounds in performance measurement loop")
+        
+        ("warmup_loop_count"
+        , hpx::program_options::value<int>()->default_value(4)
+        , "number of warmup rounds in cache warmup loop")
+        
+        ("transform_kernel"
+        , hpx::program_options::value<std::string>()->default_value("inplace")
+        , "kernel: inplace (v = v + y) or one of the STREAM kernels copy (c = a), scale (b = 3 * c), add (c = a + b) or triad (a = b + 3 * c), or chain (chained transforms of v, fused and unfused), gather (out[i] = v[idx[i]] + y[i]), scatter (out[idx[i]] = v[i] + y[i]) or fma (fma_count multiply-adds per element)")
+    
+        ("chain_length"
+        , hpx::program_options::value<std::size_t>()->default_value(0)
+        , "steps of the chain kernel: 1, 2, 4 or 8, 0 sweeps all of them")
+    
+        ("index_pattern"
+        , hpx::program_options::value<std::string>()->default_value("sequential")
+        , "indices of gather and scatter: sequential, strided, block_random or random")
+    
+        ("index_scope"
+        , hpx::program_options::value<std::string>()->default_value("local")
+        , "indices of gather and scatter: local (own partition) or global (all partitions)")
+    
+        ("index_stride"
+        , hpx::program_options::value<std::size_t>()->default_value(16)
+        , "distance of consecutive indices of the strided pattern")
+    
+        ("index_block"
+        , hpx::program_options::value<std::size_t>()->default_value(1024)
+        , "elements per block of the block_random pattern")
+    
+        ("fma_count"
+        , hpx::program_options::value<int>()->default_value(0)
+        , "multiply-adds per element of the fma kernel: 1, 2, 4, ... 256, 0 sweeps all of them")
+    
+        ("streaming_stores"
+        , hpx::program_options::value<std::string>()->default_value("auto")
+        , "non-temporal stores of the float kernels: auto (above streaming_threshold), on or off")
+    
+        ("streaming_threshold"
+        , hpx::program_options::value<std::size_t>()->default_value(std::size_t(1) << 28)
+        , "bytes of the local parts of the vectors of a kernel above which auto uses streaming stores")
+    
+        ("storage"
+        , hpx::program_options::value<std::string>()->default_value("float")
+        , "storage type of the vectors: float, bf16, fp16, int16 or int8 (scaled), or y as 32 bit integers uint32, bitpacked or delta_for (compressed)")
+    
+        ("compressed_bits"
+        , hpx::program_options::value<int>()->default_value(0)
+        , "bits per entry of the bitpacked and delta_for storage: 4, 8, 12, 16 or 24, 0 sweeps all of them")
         ;
     
     // run hpx_main on all localities
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace numa {
+
+// Compressed storage of 32 bit unsigned integers for the memory bound
+// kernels, shared by the numa_v1 benchmarks and the HPX programs. The values
+// are compressed in blocks of block_size values, a block is block_rows rows
+// of block_lanes values (value i of a block is in row i / block_lanes, lane
+// i % block_lanes). Every lane is packed into its own stream of Bits bit
+// entries and the streams are interleaved word by word (word w of lane l is
+// packed word w * block_lanes + l), so one row is decoded with the same
+// shifts for all lanes, which the compiler turns into vector instructions.
+// Bits is a template parameter, every row is unpacked with constant shifts
+// and masks.
+//
+// A block is decoded row by row, every row is handed to a sink
+// sink(row index, row) while it is still in registers. The kernels never see
+// the decoded block in memory.
+//
+// uncompressed_format: the values as they are, the baseline.
+// bitpacked_format: the values themselves with Bits bits each.
+// delta_for_format: delta plus frame of reference. A header holds the values
+//     of row 0 (base) and the smallest difference between consecutive rows
+//     of every lane (reference), the entries of the rows 1 to 31 are the
+//     differences minus the reference. For sorted data the differences of a
+//     lane span block_lanes values, they need 3 bits more than the
+//     differences of consecutive values.
+//
+// example_block generates the values of a block which fit the format with
+// Bits bits, the benchmarks use them as data.
+//
+// The header only needs C++17, the words of a block are plain 32 bit
+// integers, so the HPX programs store them in an hpx::partitioned_vector.
+
+inline constexpr std::size_t block_lanes = 8;
+inline constexpr std::size_t block_rows = 32;
+inline constexpr std::size_t block_size = block_lanes * block_rows;
+
+inline std::uint64_t splitmix64(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+template <int Bits>
+inline constexpr std::uint32_t bits_mask = Bits == 32 ? ~std::uint32_t{0} : (std::uint32_t{1} << Bits) - 1;
+
+// unpacks the entries of row K of all lanes from the packed lane streams
+template <int Bits, std::size_t K, typename Sink>
+inline void unpack_row(const std::uint32_t* packed, Sink& sink) {
+    constexpr std::size_t bit = K * Bits;
+    constexpr std::size_t word = bit / 32;
+    constexpr std::size_t shift = bit % 32;
+    std::uint32_t row[block_lanes];
+    for (std::size_t l = 0; l < block_lanes; l++) {
+        std::uint32_t value = packed[word * block_lanes + l] >> shift;
+        if constexpr (shift + Bits > 32) {
+            value |= packed[(word + 1) * block_lanes + l] << (32 - shift);
+        }
+        row[l] = value & bits_mask<Bits>;
+    }
+    sink(K, row);
+}
+
+template <int Bits, typename Sink, std::size_t... K>
+inline void unpack_rows(const std::uint32_t* packed, Sink& sink, std::index_sequence<K...>) {
+    (unpack_row<Bits, K>(packed, sink), ...);
+}
+
+// packs the entries (row by row) of a block into the lane streams
+template <int Bits>
+void pack_rows(const std::uint32_t* entries, std::uint32_t* packed) {
+    for (std::size_t w = 0; w < Bits * block_lanes; w++) {
+        packed[w] = 0;
+    }
+    for (std::size_t k = 0; k < block_rows; k++) {
+        const std::size_t bit = k * Bits;
+        const std::size_t word = bit / 32;
+        const std::size_t shift = bit % 32;
+        for (std::size_t l = 0; l < block_lanes; l++) {
+            const std::uint32_t entry = entries[k * block_lanes + l];
+            if (entry > bits_mask<Bits>) {
+                throw std::invalid_argument("entry does not fit into " + std::to_string(Bits) + " bits");
+            }
+            packed[word * block_lanes + l] |= entry << shift;
+            if (shift + Bits > 32) {
+                packed[(word + 1) * block_lanes + l] |= entry >> (32 - shift);
+            }
+        }
+    }
+}
+
+struct uncompressed_format {
+    static constexpr int bits = 32;
+    static constexpr std::size_t header_words = 0;
+    static constexpr std::size_t block_words = block_size;
+
+    static std::string name() { return "Uncompressed"; }
+
+    static void encode(const std::uint32_t* values, std::uint32_t* words) {
+        std::copy(values, values + block_size, words);
+    }
+
+    template <typename Sink>
+    static void decode(const std::uint32_t* words, Sink&& sink) {
+        for (std::size_t k = 0; k < block_rows; k++) {
+            sink(k, words + k * block_lanes);
+        }
+    }
+
+    // uniformly distributed values
+    static void example_block(std::size_t block, std::uint32_t* values) {
+        for (std::size_t i = 0; i < block_size; i++) {
+            values[i] = static_cast<std::uint32_t>(splitmix64(block * block_size + i));
+        }
+    }
+};
+
+template <int Bits>
+struct bitpacked_format {
+    static_assert(Bits >= 1 && Bits <= 32, "bitpacked_format needs 1 to 32 bits");
+
+    static constexpr int bits = Bits;
+    static constexpr std::size_t header_words = 0;
+    static constexpr std::size_t block_words = Bits * block_lanes;
+
+    static std::string name() { return "BitPacked" + std::to_string(Bits); }
+
+    static void encode(const std::uint32_t* values, std::uint32_t* words) {
+        pack_rows<Bits>(values, words);
+    }
+
+    template <typename Sink>
+    static void decode(const std::uint32_t* words, Sink&& sink) {
+        unpack_rows<Bits>(words, sink, std::make_index_sequence<block_rows>());
+    }
+
+    // uniformly distributed values of Bits bits
+    static void example_block(std::size_t block, std::uint32_t* values) {
+        for (std::size_t i = 0; i < block_size; i++) {
+            values[i] = static_cast<std::uint32_t>(splitmix64(block * block_size + i)) & bits_mask<Bits>;
+        }
+    }
+};
+
+template <int Bits>
+struct delta_for_format {
+    static_assert(Bits >= 4 && Bits <= 32, "delta_for_format needs 4 to 32 bits");
+
+    static constexpr int bits = Bits;
+    static constexpr std::size_t header_words = 2 * block_lanes;
+    static constexpr std::size_t block_words = header_words + Bits * block_lanes;
+
+    static std::string name() { return "DeltaFor" + std::to_string(Bits); }
+
+    static void encode(const std::uint32_t* values, std::uint32_t* words) {
+        std::uint32_t* base = words;
+        std::uint32_t* reference = words + block_lanes;
+        std::uint32_t entries[block_size] = {};
+        for (std::size_t l = 0; l < block_lanes; l++) {
+            base[l] = values[l];
+            std::int32_t smallest = 0;
+            for (std::size_t k = 1; k < block_rows; k++) {
+                const auto delta = static_cast<std::int32_t>(values[k * block_lanes + l] - values[(k - 1) * block_lanes + l]);
+                smallest = (k == 1 || delta < smallest) ? delta : smallest;
+            }
+            reference[l] = static_cast<std::uint32_t>(smallest);
+            for (std::size_t k = 1; k < block_rows; k++) {
+                const std::uint32_t delta = values[k * block_lanes + l] - values[(k - 1) * block_lanes + l];
+                entries[k * block_lanes + l] = delta - reference[l];
+            }
+        }
+        pack_rows<Bits>(entries, words + header_words);
+    }
+
+    template <typename Sink>
+    static void decode(const std::uint32_t* words, Sink&& sink) {
+        std::uint32_t row[block_lanes];
+        std::uint32_t reference[block_lanes];
+        for (std::size_t l = 0; l < block_lanes; l++) {
+            row[l] = words[l];
+            reference[l] = words[block_lanes + l];
+        }
+        auto delta_sink = [&] (std::size_t k, const std::uint32_t* entries) {
+            if (k != 0) {
+                for (std::size_t l = 0; l < block_lanes; l++) {
+                    row[l] += entries[l] + reference[l];
+                }
+            }
+            sink(k, row);
+        };
+        unpack_rows<Bits>(words + header_words, delta_sink, std::make_index_sequence<block_rows>());
+    }
+
+    // sorted values with increments of Bits - 3 bits from a random start
+    static void example_block(std::size_t block, std::uint32_t* values) {
+        std::uint32_t value = static_cast<std::uint32_t>(splitmix64(block));
+        for (std::size_t i = 0; i < block_size; i++) {
+            value += static_cast<std::uint32_t>(splitmix64(block * block_size + i)) & bits_mask<Bits - 3>;
+            values[i] = value;
+        }
+    }
+};
+
+// bits per value of the format, including the header
+template <typename Format>
+constexpr double bits_per_value() {
+    return 32.0 * Format::block_words / block_size;
+}
+
+// [first, last) blocks of the words [first_word, last_word) of a node, a
+// block belongs to the node which holds its first word
+inline std::pair<std::size_t, std::size_t> block_range(std::pair<std::size_t, std::size_t> words, std::size_t block_words) {
+    return std::make_pair((words.first + block_words - 1) / block_words, (words.second + block_words - 1) / block_words);
+}
+
+}
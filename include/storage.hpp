@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace numa {
+
+// Reduced precision storage types for the memory bound kernels, shared by the
+// numa_v1 benchmarks and the HPX programs. The kernels load the stored
+// elements, convert them to float in software and compute in float or double.
+// Every storage type has a codec with decode (storage to float) and encode
+// (float to storage, round to nearest even). Scaled integers represent
+// value * scale, the scale is chosen from the largest magnitude the vector has
+// to hold. name labels the storage type in the benchmark output.
+//
+// The header only needs C++17, the storage types can be serialized so they
+// can be elements of an hpx::partitioned_vector.
+
+struct bfloat16 {
+    std::uint16_t bits;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int) { ar & bits; }
+};
+
+struct float16 {
+    std::uint16_t bits;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int) { ar & bits; }
+};
+
+struct int8_scaled {
+    std::int8_t value;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int) { ar & value; }
+};
+
+struct int16_scaled {
+    std::int16_t value;
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int) { ar & value; }
+};
+
+inline std::uint32_t float_bits(float x) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+inline float bits_float(std::uint32_t bits) {
+    float x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+template <typename Storage>
+struct storage_codec;
+
+template <>
+struct storage_codec<float> {
+    static constexpr const char* name = "Float";
+
+    explicit storage_codec(float) { }
+
+    float decode(float x) const { return x; }
+
+    float encode(float x) const { return x; }
+};
+
+// upper 16 bits of a float
+template <>
+struct storage_codec<bfloat16> {
+    static constexpr const char* name = "Bf16";
+
+    explicit storage_codec(float) { }
+
+    float decode(bfloat16 x) const {
+        return bits_float(static_cast<std::uint32_t>(x.bits) << 16);
+    }
+
+    bfloat16 encode(float x) const {
+        std::uint32_t bits = float_bits(x);
+        bits += 0x7fff + ((bits >> 16) & 1);
+        return bfloat16{static_cast<std::uint16_t>(bits >> 16)};
+    }
+};
+
+// IEEE 754 half precision. Decoding shifts exponent and mantissa into a float
+// and rescales the exponent with one multiplication, which also handles the
+// subnormals, infinities and NaNs are fixed up branch free.
+template <>
+struct storage_codec<float16> {
+    static constexpr const char* name = "Fp16";
+
+    explicit storage_codec(float) { }
+
+    float decode(float16 x) const {
+        std::uint32_t const magnitude = static_cast<std::uint32_t>(x.bits & 0x7fff) << 13;
+        float f = bits_float(magnitude) * 0x1p112f;
+        std::uint32_t bits = float_bits(f);
+        bits |= (f >= 65536.0f) ? (std::uint32_t{255} << 23) : 0;
+        bits |= static_cast<std::uint32_t>(x.bits & 0x8000) << 16;
+        return bits_float(bits);
+    }
+
+    float16 encode(float x) const {
+        constexpr std::uint32_t f32_infinity = std::uint32_t{255} << 23;
+        constexpr std::uint32_t f16_overflow = std::uint32_t{127 + 16} << 23;
+        constexpr std::uint32_t f16_min_normal = std::uint32_t{127 - 14} << 23;
+        constexpr std::uint32_t denormal_magic = std::uint32_t{(127 - 15) + (23 - 10) + 1} << 23;
+
+        std::uint32_t bits = float_bits(x);
+        std::uint32_t const sign = bits & 0x80000000u;
+        bits ^= sign;
+
+        std::uint16_t result;
+        if (bits >= f16_overflow) {
+            result = (bits > f32_infinity) ? 0x7e00 : 0x7c00;
+        } else if (bits < f16_min_normal) {
+            // the addition rounds the mantissa into the subnormal position
+            float const shifted = bits_float(bits) + bits_float(denormal_magic);
+            result = static_cast<std::uint16_t>(float_bits(shifted) - denormal_magic);
+        } else {
+            std::uint32_t const mantissa_odd = (bits >> 13) & 1;
+            bits -= std::uint32_t{127 - 15} << 23;
+            bits += 0xfff + mantissa_odd;
+            result = static_cast<std::uint16_t>(bits >> 13);
+        }
+        return float16{static_cast<std::uint16_t>(result | (sign >> 16))};
+    }
+};
+
+template <typename Int, typename Storage>
+struct scaled_codec {
+    float scale;
+
+    explicit scaled_codec(float max_abs)
+        : scale(max_abs / (std::numeric_limits<Int>::max)()) { }
+
+    float decode(Storage x) const { return static_cast<float>(x.value) * scale; }
+
+    Storage encode(float x) const {
+        float const q = std::nearbyint(x / scale);
+        float const limit = (std::numeric_limits<Int>::max)();
+        return Storage{static_cast<Int>(std::clamp(q, -limit, limit))};
+    }
+};
+
+template <>
+struct storage_codec<int8_scaled> : scaled_codec<std::int8_t, int8_scaled> {
+    static constexpr const char* name = "Int8";
+
+    using scaled_codec::scaled_codec;
+};
+
+template <>
+struct storage_codec<int16_scaled> : scaled_codec<std::int16_t, int16_scaled> {
+    static constexpr const char* name = "Int16";
+
+    using scaled_codec::scaled_codec;
+};
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace numa {
+
+// Non-temporal (streaming) stores of float vectors, shared by the numa_v1
+// benchmarks and the HPX transform. A streaming store writes a whole cache
+// line to memory without reading it first (no write allocate) and without
+// evicting other lines from the caches. The intrinsics are used where the
+// compiler provides them, otherwise the stores are plain stores.
+
+#if defined(__AVX__)
+inline constexpr std::size_t stream_width = 8;
+#elif defined(__SSE__)
+inline constexpr std::size_t stream_width = 4;
+#else
+inline constexpr std::size_t stream_width = 1;
+#endif
+
+// stream_width values to out, which is aligned to stream_width floats
+inline void stream_store(float* out, const float* values) {
+#if defined(__AVX__)
+    _mm256_stream_ps(out, _mm256_loadu_ps(values));
+#elif defined(__SSE__)
+    _mm_stream_ps(out, _mm_loadu_ps(values));
+#else
+    std::copy(values, values + stream_width, out);
+#endif
+}
+
+// orders the streaming stores before the following stores, has to be called
+// before another thread reads the output
+inline void stream_fence() {
+#if defined(__SSE__)
+    _mm_sfence();
+#endif
+}
+
+// out[i] = op(a[i], b[i]) for i in [0, n) with streaming stores. The elements
+// in front of the first aligned element of out and behind the last full
+// vector are stored with plain stores.
+template <typename Op>
+void stream_transform(const float* a, const float* b, float* out, std::size_t n, Op op) {
+    std::size_t i = 0;
+    for (; i < n && reinterpret_cast<std::uintptr_t>(out + i) % (stream_width * sizeof(float)) != 0; i++) {
+        out[i] = op(a[i], b[i]);
+    }
+    for (; i + stream_width <= n; i += stream_width) {
+        alignas(32) float values[stream_width];
+        for (std::size_t l = 0; l < stream_width; l++) {
+            values[l] = op(a[i + l], b[i + l]);
+        }
+        stream_store(out + i, values);
+    }
+    for (; i < n; i++) {
+        out[i] = op(a[i], b[i]);
+    }
+    stream_fence();
+}
+
+}
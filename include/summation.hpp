@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace numa {
+
+// Accumulators for the summation modes of the reduction benchmarks, shared by
+// the numa_v1 benchmarks and the HPX programs. Every accumulator collects
+// ranges [first, last) of random access iterators with add_range, is combined
+// with the accumulator of another range with merge and delivers the sum with
+// value.
+//
+// The header only needs C++17, the accumulators can be serialized so they can
+// be elements of an hpx::partitioned_vector.
+
+// plain running sum, the order of the additions is up to the compiler
+template <typename T>
+struct plain_sum {
+    T sum{0};
+
+    template <typename Iter>
+    void add_range(Iter first, Iter last) {
+        const std::size_t n = last - first;
+        T ret{0};
+        #pragma omp simd reduction(+ : ret)
+        for (std::size_t i = 0; i < n; i++) {
+            ret += first[i];
+        }
+        sum += ret;
+    }
+
+    void merge(const plain_sum& other) { sum += other.sum; }
+
+    T value() const { return sum; }
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int) { ar & sum; }
+};
+
+// Kahan-Babuska-Neumaier compensated sum, the rounding error of every
+// addition is collected in compensation
+template <typename T>
+struct compensated_sum {
+    T sum{0};
+    T compensation{0};
+
+    void add(T x) {
+        T t = sum + x;
+        if (std::abs(sum) >= std::abs(x)) {
+            compensation += (sum - t) + x;
+        } else {
+            compensation += (x - t) + sum;
+        }
+        sum = t;
+    }
+
+    template <typename Iter>
+    void add_range(Iter first, Iter last) {
+        for (; first != last; ++first) {
+            add(*first);
+        }
+    }
+
+    void merge(const compensated_sum& other) {
+        add(other.sum);
+        compensation += other.compensation;
+    }
+
+    T value() const { return sum + compensation; }
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int) { ar & sum & compensation; }
+};
+
+// pairwise (cascade) summation of every range, blocks of pairwise_block
+// elements are summed up directly
+template <typename T>
+struct pairwise_sum {
+    static constexpr std::size_t pairwise_block = 128;
+
+    T sum{0};
+
+    template <typename Iter>
+    static T pairwise(Iter first, Iter last) {
+        const std::size_t n = last - first;
+        if (n <= pairwise_block) {
+            T ret{0};
+            #pragma omp simd reduction(+ : ret)
+            for (std::size_t i = 0; i < n; i++) {
+                ret += first[i];
+            }
+            return ret;
+        }
+        Iter middle = first + n / 2;
+        return pairwise(first, middle) + pairwise(middle, last);
+    }
+
+    template <typename Iter>
+    void add_range(Iter first, Iter last) { sum += pairwise(first, last); }
+
+    void merge(const pairwise_sum& other) { sum += other.sum; }
+
+    T value() const { return sum; }
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int) { ar & sum; }
+};
+
+// Exact, bitwise reproducible sum of floats (binned superaccumulator).
+// Every float is m * 2^(e - 150) with its 24 bit significand m and its biased
+// exponent e, bins[e] accumulates the signed m of all values with exponent e.
+// Integer additions are exact and associative, so the result does not depend
+// on the thread count, the grain size or the order of the merges. A bin holds
+// at least 2^39 values.
+struct binned_sum {
+    static constexpr int num_bins = 256;
+
+    std::array<std::int64_t, num_bins> bins{};
+
+    void add(float x) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        std::uint32_t exponent = (bits >> 23) & 0xff;
+        std::int64_t significand = bits & 0x7fffff;
+        if (exponent != 0) {
+            significand |= 0x800000;
+        } else {
+            exponent = 1;    // subnormals share the scale of exponent 1
+        }
+        bins[exponent] += (bits >> 31) ? -significand : significand;
+    }
+
+    template <typename Iter>
+    void add_range(Iter first, Iter last) {
+        for (; first != last; ++first) {
+            add(*first);
+        }
+    }
+
+    void merge(const binned_sum& other) {
+        for (int e = 0; e < num_bins; e++) {
+            bins[e] += other.bins[e];
+        }
+    }
+
+    // The carries are propagated until every bin but the last is 0 or 1, the
+    // result is then a binary number with one bit per bin and the bits from
+    // the last bin up in the last bin. Its leading 24 bits are the
+    // significand, the bits below round it to nearest even, so the sum is
+    // rounded exactly once. A negative sum is normalized as its magnitude,
+    // otherwise the carries would leave a two's complement pattern behind.
+    float value() const {
+        constexpr int last = num_bins - 1;
+        constexpr int significand_bits = std::numeric_limits<float>::digits;
+
+        std::array<std::int64_t, num_bins> digits = normalized(1);
+        float sign = 1;
+        if (digits[last] < 0) {
+            digits = normalized(-1);
+            sign = -1;
+        }
+
+        // bit p of the binary number, the bins from 0 to last - 1 hold one bit
+        auto bit = [&] (int p) -> std::uint32_t {
+            if (p >= last) {
+                return static_cast<std::uint32_t>((digits[last] >> (p - last)) & 1);
+            }
+            return static_cast<std::uint32_t>(digits[p]);
+        };
+
+        int top = -1;
+        for (std::int64_t high = digits[last]; high != 0; high >>= 1) {
+            top = top < 0 ? last : top + 1;
+        }
+        for (int e = last - 1; e >= 0 && top < 0; e--) {
+            if (digits[e] != 0) {
+                top = e;
+            }
+        }
+        if (top < 0) {
+            return 0;
+        }
+
+        // bin 1 is the scale of the subnormals, there are no bits below
+        const int lowest = std::max(top - significand_bits + 1, 1);
+        std::uint32_t significand = 0;
+        for (int p = top; p >= lowest; p--) {
+            significand = (significand << 1) | bit(p);
+        }
+        std::uint32_t sticky = 0;
+        for (int p = lowest - 2; p >= 0; p--) {
+            sticky |= bit(p);
+        }
+        if (bit(lowest - 1) && (sticky || (significand & 1))) {
+            significand++;
+        }
+        return sign * std::ldexp(static_cast<float>(significand), lowest - 150);
+    }
+
+    template <typename Archive>
+    void serialize(Archive& ar, unsigned int) {
+        for (auto& bin : bins) {
+            ar & bin;
+        }
+    }
+
+private:
+    std::array<std::int64_t, num_bins> normalized(std::int64_t sign) const {
+        std::array<std::int64_t, num_bins> digits;
+        for (int e = 0; e < num_bins; e++) {
+            digits[e] = sign * bins[e];
+        }
+        for (int e = 0; e + 1 < num_bins; e++) {
+            std::int64_t carry = digits[e] >> 1;
+            digits[e] -= 2 * carry;
+            digits[e + 1] += carry;
+        }
+        return digits;
+    }
+};
+
+// Test values of the summation modes. A period of 8 values mixes magnitudes
+// from 2^20 down to 2^-10 with both signs and sums up to exactly 1 + 2^-10, a
+// float accumulator loses the small values next to the large ones. All values
+// are multiples of 2^-10 below 2^21, so the exact sum of any number of values
+// is exact in double.
+inline constexpr float summation_period[8] = {
+    1048576.0f, 0.75f, -1048576.0f, -3.0f, 1024.0f, 0.0009765625f, -1024.0f, 3.25f};
+
+inline float summation_value(std::uint64_t i) {
+    return summation_period[i % 8];
+}
+
+// exact sum of the first count summation values
+inline double summation_exact_sum(std::uint64_t count) {
+    double sum = static_cast<double>(count / 8) * (1 + 0x1p-10);
+    for (std::uint64_t i = 0; i < count % 8; i++) {
+        sum += summation_period[i];
+    }
+    return sum;
+}
+
+}
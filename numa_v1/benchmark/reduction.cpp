@@ -1,13 +1,18 @@
 #include <benchmark/benchmark.h>
 #include <vector>
 #include <iostream>
+#include <cmath>
 
 #include <oneapi/tbb/parallel_reduce.h>
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/partitioner.h>
+#include <oneapi/tbb/parallel_for.h>
 
 #include "arenaV3.hpp"
 #include "numa_adaptor.hpp"
+#include "summation.hpp"
+#include "storage.hpp"
+#include "compressed.hpp"
 
 using ValueType = float;
 using ContainerType = std::vector<float, numa::no_init_allocator<float>>;
@@ -33,6 +38,16 @@ void setCustomCounter(benchmark::State& state, std::string name) {
   state.SetLabel(name);
 }
 
+// Elements and Bytes as rates (items_per_second, bytes_per_second) as well,
+// Bytes counts the stored bytes of the storage type.
+void setStorageCounter(benchmark::State& state, std::string name, size_t bytes_per_element) {
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) * bytes_per_element);
+  state.counters["Elements"] = state.range(0);
+  state.counters["Bytes"] = state.range(0) * bytes_per_element;
+  state.SetLabel(name);
+}
+
 static void benchReduceOmpNoInit(benchmark::State& state){
     ContainerType X(state.range(0));
     auto places = omp_get_num_places();
@@ -208,10 +223,237 @@ static void benchReduceTbbNoInit2(benchmark::State& state){
     setCustomCounter(state, "ReduceTbbNoInitV7");
 }
 
+// Reduction with the summation mode Sum (plain, compensated, pairwise or
+// binned, see summation.hpp). The values mix magnitudes from 2^20 down to
+// 2^-10, so the modes round differently; RelError is the relative error
+// against the exact sum of the values.
+template <typename Sum>
+static Sum reduceSumModeTbb(numa::ArenaMgtTBBV3& arenas, numa_adaptor<ValueType, ContainerType>& X,
+                            std::vector<Sum>& node_sums, Partitioner& part) {
+    arenas.execute([&] (const int i) {
+        node_sums[i] = tbb::parallel_reduce(tbb::blocked_range<size_t>(X.get_range(i).first, X.get_range(i).second, gs), Sum{},
+                                        [&] (const tbb::blocked_range<size_t> r, Sum ret) -> Sum {
+            ret.add_range(X.data() + r.begin(), X.data() + r.end());
+            return ret;
+        }, [] (Sum lhs, const Sum& rhs) -> Sum {
+            lhs.merge(rhs);
+            return lhs;
+        }, part);
+    });
+
+    Sum result;
+    for (auto& sum : node_sums) result.merge(sum);
+    return result;
+}
+
+template <typename Sum> constexpr const char* sumModeLabel = "";
+template <> constexpr const char* sumModeLabel<numa::plain_sum<ValueType>> = "ReduceSumPlainTbbNoInit";
+template <> constexpr const char* sumModeLabel<numa::compensated_sum<ValueType>> = "ReduceSumCompensatedTbbNoInit";
+template <> constexpr const char* sumModeLabel<numa::pairwise_sum<ValueType>> = "ReduceSumPairwiseTbbNoInit";
+template <> constexpr const char* sumModeLabel<numa::binned_sum> = "ReduceSumReproducibleTbbNoInit";
+
+template <typename Sum>
+static void benchReduceSumModeTbbNoInit(benchmark::State& state){
+    numa::ArenaMgtTBBV3 arenas;
+    numa_adaptor<ValueType, ContainerType> X(state.range(0), 1, arenas);
+    ValueType result;
+    Partitioner part;
+
+    // mixed magnitudes and signs with a known exact sum (see summation.hpp),
+    // written by the arena of the node
+    arenas.execute([&] (const int i) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(X.get_range(i).first, X.get_range(i).second), [&] (const tbb::blocked_range<size_t> r) {
+            for (auto j = r.begin(); j < r.end(); j++) {
+                X[j] = numa::summation_value(j);
+            }
+        });
+    });
+    const double exact = numa::summation_exact_sum(state.range(0));
+
+    std::vector<Sum> node_sums(arenas.get_nodes());
+    for (auto _ : state){
+        result = reduceSumModeTbb(arenas, X, node_sums, part).value();
+        benchmark::DoNotOptimize(&result);
+        benchmark::ClobberMemory();
+    }
+
+    setCustomCounter(state, sumModeLabel<Sum>);
+    state.counters["RelError"] = std::abs(result - exact) / exact;
+}
+
+// Reduction over reduced precision storage (see storage.hpp), every element
+// is decoded to float and accumulated in Acc.
+template <typename Storage, typename Acc>
+static void benchReduceStorageTbbNoInit(benchmark::State& state){
+    using StorageContainer = std::vector<Storage, numa::no_init_allocator<Storage>>;
+    numa::ArenaMgtTBBV3 arenas;
+    const numa::storage_codec<Storage> codec(2);
+    numa_adaptor<Storage, StorageContainer> X(state.range(0), codec.encode(1), arenas);
+    std::vector<Acc> node_sums(arenas.get_nodes());
+    Acc result;
+    Partitioner part;
+
+    for (auto _ : state){
+        result = 0;
+        arenas.execute([&] (const int i) {
+            node_sums[i] = tbb::parallel_reduce(tbb::blocked_range<size_t>(X.get_range(i).first, X.get_range(i).second, gs), Acc{0},
+                                            [&] (const tbb::blocked_range<size_t> r, Acc ret) -> Acc {
+                #pragma omp simd reduction(+ : ret)
+                for (auto j = r.begin(); j < r.end(); j++) {
+                    ret += codec.decode(X[j]);
+                }
+                return ret;
+            }, std::plus<>{}, part);
+        });
+
+        for (auto sum : node_sums) result += sum;
+        benchmark::DoNotOptimize(&result);
+        benchmark::ClobberMemory();
+    }
+
+    setStorageCounter(state, std::string("ReduceStorage") + codec.name + (sizeof(Acc) == sizeof(double) ? "Double" : "Float") + "TbbNoInit",
+                      sizeof(Storage));
+}
+
+// Bytes and CompressionRatio of integer data stored in compressed blocks
+// (see compressed.hpp), Elements and Bytes as rates as well.
+void setCompressedCounter(benchmark::State& state, std::string name, double bytes, bool correct) {
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * bytes);
+  state.counters["Elements"] = state.range(0);
+  state.counters["Bytes"] = bytes;
+  state.counters["CompressionRatio"] = state.range(0) * sizeof(std::uint32_t) / bytes;
+  state.counters["Errors"] = !correct;
+  state.SetLabel(name);
+}
+
+// Sum of uncompressed 32 bit integers, the baseline of the compressed sums.
+static void benchReduceUncompressedTbbNoInit(benchmark::State& state){
+    using WordContainer = std::vector<std::uint32_t, numa::no_init_allocator<std::uint32_t>>;
+    numa::ArenaMgtTBBV3 arenas;
+    numa_adaptor<std::uint32_t, WordContainer> X(state.range(0), 0, arenas);
+    arenas.execute([&] (const int i) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(X.get_range(i).first, X.get_range(i).second), [&] (const tbb::blocked_range<size_t> r) {
+            for (auto j = r.begin(); j < r.end(); j++) {
+                X[j] = static_cast<std::uint32_t>(numa::splitmix64(j));
+            }
+        });
+    });
+    std::uint64_t expected = 0;
+    for (size_t j = 0; j < X.size(); j++) expected += X[j];
+    std::vector<std::uint64_t> node_sums(arenas.get_nodes());
+    std::uint64_t result;
+    Partitioner part;
+
+    for (auto _ : state){
+        result = 0;
+        arenas.execute([&] (const int i) {
+            node_sums[i] = tbb::parallel_reduce(tbb::blocked_range<size_t>(X.get_range(i).first, X.get_range(i).second, gs), std::uint64_t{0},
+                                            [&] (const tbb::blocked_range<size_t> r, std::uint64_t ret) -> std::uint64_t {
+                #pragma omp simd reduction(+ : ret)
+                for (auto j = r.begin(); j < r.end(); j++) {
+                    ret += X[j];
+                }
+                return ret;
+            }, std::plus<>{}, part);
+        });
+
+        for (auto sum : node_sums) result += sum;
+        benchmark::DoNotOptimize(&result);
+        benchmark::ClobberMemory();
+    }
+
+    setCompressedCounter(state, "ReduceUncompressedTbbNoInit", state.range(0) * sizeof(std::uint32_t), result == expected);
+}
+
+// Sum of 32 bit integers stored in compressed blocks of Format. Every block
+// is decoded row by row in registers and the rows are summed lane by lane,
+// the decoded values never go to memory. A node reduces the blocks which
+// start in its part of the compressed words.
+template <typename Format>
+static void benchReduceCompressedTbbNoInit(benchmark::State& state){
+    using WordContainer = std::vector<std::uint32_t, numa::no_init_allocator<std::uint32_t>>;
+    const size_t blocks = state.range(0) / numa::block_size;
+    numa::ArenaMgtTBBV3 arenas;
+    numa_adaptor<std::uint32_t, WordContainer> X(blocks * Format::block_words, 0, arenas);
+    std::vector<std::uint64_t> node_sums(arenas.get_nodes());
+
+    // encode the blocks on the nodes which hold them
+    arenas.execute([&] (const int i) {
+        auto [first, last] = numa::block_range(X.get_range(i), Format::block_words);
+        node_sums[i] = tbb::parallel_reduce(tbb::blocked_range<size_t>(first, last), std::uint64_t{0},
+                                        [&] (const tbb::blocked_range<size_t> r, std::uint64_t ret) -> std::uint64_t {
+            std::uint32_t values[numa::block_size];
+            for (auto b = r.begin(); b < r.end(); b++) {
+                Format::example_block(b, values);
+                Format::encode(values, X.data() + b * Format::block_words);
+                for (auto value : values) ret += value;
+            }
+            return ret;
+        }, std::plus<>{});
+    });
+    std::uint64_t expected = 0;
+    for (auto sum : node_sums) expected += sum;
+    std::uint64_t result;
+    Partitioner part;
+
+    for (auto _ : state){
+        result = 0;
+        arenas.execute([&] (const int i) {
+            auto [first, last] = numa::block_range(X.get_range(i), Format::block_words);
+            node_sums[i] = tbb::parallel_reduce(tbb::blocked_range<size_t>(first, last, gs / numa::block_size), std::uint64_t{0},
+                                            [&] (const tbb::blocked_range<size_t> r, std::uint64_t ret) -> std::uint64_t {
+                std::uint64_t lanes[numa::block_lanes] = {};
+                for (auto b = r.begin(); b < r.end(); b++) {
+                    Format::decode(X.data() + b * Format::block_words, [&] (size_t, const std::uint32_t* row) {
+                        for (size_t l = 0; l < numa::block_lanes; l++) {
+                            lanes[l] += row[l];
+                        }
+                    });
+                }
+                for (auto lane : lanes) ret += lane;
+                return ret;
+            }, std::plus<>{}, part);
+        });
+
+        for (auto sum : node_sums) result += sum;
+        benchmark::DoNotOptimize(&result);
+        benchmark::ClobberMemory();
+    }
+
+    setCompressedCounter(state, "ReduceCompressed" + Format::name() + "TbbNoInit",
+                         blocks * Format::block_words * sizeof(std::uint32_t), result == expected);
+}
+
 BENCHMARK(benchReduceOmpNoInit)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceOmpNoInit2)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceOmpNestingNoInit)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceOmpNestingNoInit2)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceTbbNoInit)->Apply(Args)->UseRealTime();
 BENCHMARK(benchReduceTbbNoInit2)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSumModeTbbNoInit, numa::plain_sum<ValueType>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSumModeTbbNoInit, numa::compensated_sum<ValueType>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSumModeTbbNoInit, numa::pairwise_sum<ValueType>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceSumModeTbbNoInit, numa::binned_sum)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, float, float)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, float, double)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, numa::bfloat16, float)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, numa::bfloat16, double)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, numa::float16, float)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, numa::float16, double)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, numa::int16_scaled, float)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, numa::int16_scaled, double)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, numa::int8_scaled, float)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceStorageTbbNoInit, numa::int8_scaled, double)->Apply(Args)->UseRealTime();
+BENCHMARK(benchReduceUncompressedTbbNoInit)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::bitpacked_format<4>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::bitpacked_format<8>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::bitpacked_format<12>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::bitpacked_format<16>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::bitpacked_format<24>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::delta_for_format<4>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::delta_for_format<8>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::delta_for_format<12>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::delta_for_format<16>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchReduceCompressedTbbNoInit, numa::delta_for_format<24>)->Apply(Args)->UseRealTime();
 BENCHMARK_MAIN();
\ No newline at end of file
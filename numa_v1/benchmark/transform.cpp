@@ -1,9 +1,15 @@
 #include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
 #include <vector>
 
 #include "allocator_adaptor.hpp"
 #include "numa_adaptor.hpp"
 #include "arenaV3.hpp"
+#include "storage.hpp"
+#include "streaming_store.hpp"
+#include "compressed.hpp"
 
 using ValueType = float;
 using ContainerType = std::vector<ValueType, numa::no_init_allocator<ValueType>>;
@@ -11,6 +17,17 @@ using namespace oneapi;
 using Partitioner = tbb::static_partitioner;
 static constexpr int numa_nodes = 4;
 static constexpr int thrds_per_node = 32;
+// bytes of all arrays of a kernel above which the Auto variants use
+// streaming stores, larger than the last level caches of a node by default.
+// The environment variable STREAMING_THRESHOLD overrides it (in bytes), like
+// --streaming_threshold of the HPX transform.
+static size_t streamingThreshold() {
+    static const size_t threshold = [] {
+        const char* value = std::getenv("STREAMING_THRESHOLD");
+        return (value && *value) ? static_cast<size_t>(std::stoull(value)) : size_t{1} << 28;
+    }();
+    return threshold;
+}
 
 static void Args(benchmark::internal::Benchmark* b) {
   const int64_t lowerLimit = 15;
@@ -27,6 +44,102 @@ void setCustomCounter(benchmark::State& state, std::string name) {
   state.SetLabel(name);
 }
 
+// Elements and Bytes as rates (items_per_second, bytes_per_second) as well,
+// Bytes counts the stored bytes of the storage type.
+void setStorageCounter(benchmark::State& state, std::string name, size_t bytes_per_element) {
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * 3 * state.range(0) * bytes_per_element);
+  state.counters["Elements"] = state.range(0);
+  state.counters["Bytes"] = 3 * state.range(0) * bytes_per_element;
+  state.SetLabel(name);
+}
+
+// Bytes of a transform Y = alpha * X + Y with integer X stored in compressed
+// blocks (see compressed.hpp), X is read once, Y is read and written.
+void setCompressedCounter(benchmark::State& state, std::string name, double compressed_bytes) {
+  const double bytes = compressed_bytes + 2 * state.range(0) * sizeof(ValueType);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * bytes);
+  state.counters["Elements"] = state.range(0);
+  state.counters["Bytes"] = bytes;
+  state.counters["CompressionRatio"] = state.range(0) * sizeof(std::uint32_t) / compressed_bytes;
+  state.SetLabel(name);
+}
+
+// STREAM counts every array which is read or written once (Bytes). A store to
+// a line which is not in the cache reads the line first (write allocate), so
+// the memory traffic of the STREAM kernels with cached stores is one array
+// more (BytesWriteAllocate). Streaming stores skip the read, with them
+// BytesWriteAllocate is Bytes.
+void setStreamCounter(benchmark::State& state, std::string name, size_t arrays, bool streaming) {
+  const double bytes = arrays * state.range(0) * sizeof(ValueType);
+  const double bytesWriteAllocate = (streaming ? arrays : arrays + 1) * state.range(0) * sizeof(ValueType);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * arrays * state.range(0) * sizeof(ValueType));
+  state.counters["Elements"] = state.range(0);
+  state.counters["Bytes"] = bytes;
+  state.counters["BytesWriteAllocate"] = bytesWriteAllocate;
+  state.counters["BytesWriteAllocatePerSecond"] =
+      benchmark::Counter(state.iterations() * bytesWriteAllocate, benchmark::Counter::kIsRate);
+  state.SetLabel(name);
+}
+
+// The four STREAM kernels over the separate arrays A, B and C.
+enum class StreamKernel { copy, scale, add, triad };
+
+constexpr const char* streamKernelName(StreamKernel kernel) {
+    switch (kernel) {
+        case StreamKernel::copy: return "Copy";
+        case StreamKernel::scale: return "Scale";
+        case StreamKernel::add: return "Add";
+        default: return "Triad";
+    }
+}
+
+// arrays read and written by the kernel
+constexpr size_t streamArrays(StreamKernel kernel) {
+    return (kernel == StreamKernel::copy || kernel == StreamKernel::scale) ? 2 : 3;
+}
+
+template <StreamKernel Kernel, typename Array>
+inline void streamStep(Array& A, Array& B, Array& C, size_t j) {
+    constexpr ValueType scalar = 3;
+    if constexpr (Kernel == StreamKernel::copy) {
+        C[j] = A[j];
+    } else if constexpr (Kernel == StreamKernel::scale) {
+        B[j] = scalar * C[j];
+    } else if constexpr (Kernel == StreamKernel::add) {
+        C[j] = A[j] + B[j];
+    } else {
+        A[j] = B[j] + scalar * C[j];
+    }
+}
+
+// Stores of the output array: cached (plain stores), streaming (non-temporal
+// stores, see streaming_store.hpp) or automatic (streaming if the arrays of
+// the kernel are larger than streamingThreshold())
+enum class StoreMode { cached, streaming, automatic };
+
+constexpr const char* storeModeName(StoreMode mode) {
+    switch (mode) {
+        case StoreMode::cached: return "";
+        case StoreMode::streaming: return "Streaming";
+        default: return "Auto";
+    }
+}
+
+bool useStreaming(StoreMode mode, size_t bytes) {
+    return mode == StoreMode::streaming || (mode == StoreMode::automatic && bytes > streamingThreshold());
+}
+
+// [first, last) of the calling thread among n elements, like the static
+// schedule of omp for
+std::pair<size_t, size_t> threadRange(size_t n) {
+    size_t thread = omp_get_thread_num();
+    size_t threads = omp_get_num_threads();
+    return std::make_pair(n * thread / threads, n * (thread + 1) / threads);
+}
+
 static void benchTransformOmpNoInit(benchmark::State& state){
     ContainerType X(state.range(0));
     ContainerType Y(state.range(0));
@@ -51,6 +164,39 @@ static void benchTransformOmpNoInit(benchmark::State& state){
     setCustomCounter(state, "TransformOmpNoInit");
 }
 
+// The transform into a separate output array, Z = alpha * X + Y, with the
+// stores of Z chosen by Mode. Z is not read by the kernel, so cached stores
+// read its lines first (write allocate) and streaming stores save that
+// traffic, see setStreamCounter.
+template <StoreMode Mode>
+static void benchTransformOmpStoreNoInit(benchmark::State& state){
+    numa_adaptor<ValueType, ContainerType> X(state.range(0), 1, numa_nodes);
+    numa_adaptor<ValueType, ContainerType> Y(state.range(0), 1, numa_nodes);
+    numa_adaptor<ValueType, ContainerType> Z(state.range(0), 0, numa_nodes);
+    constexpr ValueType alpha = 2;
+    const bool streaming = useStreaming(Mode, 3 * X.size() * sizeof(ValueType));
+
+    for (auto _ : state){
+        if (streaming) {
+            #pragma omp parallel
+            {
+                auto [first, last] = threadRange(X.size());
+                numa::stream_transform(X.data() + first, Y.data() + first, Z.data() + first, last - first,
+                    [alpha] (ValueType x, ValueType y) { return alpha * x + y; });
+            }
+        } else {
+            #pragma omp parallel for 
+            for (size_t i = 0; i < X.size(); i++){
+                Z[i] = alpha * X[i] + Y[i];
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+
+    setStreamCounter(state, std::string("TransformOmpStore") + storeModeName(Mode) + "NoInit", 3, streaming);
+    state.counters["StreamingStores"] = streaming;
+}
+
 static void benchTransformOmpNoInit2(benchmark::State& state){
     ContainerType X(state.range(0));
     ContainerType Y(state.range(0));
@@ -186,10 +332,346 @@ static void benchTransformTbbNoInit2(benchmark::State& state) {
     }
 }
 
+// Transform over reduced precision storage (see storage.hpp), X and Y are
+// decoded to float and the result is encoded again. X holds zeros, so Y keeps
+// its value and stays representable in every storage type, the work per
+// element does not depend on the values.
+template <typename Storage>
+static void benchTransformStorageTbbNoInit(benchmark::State& state) {
+    using StorageContainer = std::vector<Storage, numa::no_init_allocator<Storage>>;
+    numa::ArenaMgtTBBV3 arena;
+    const numa::storage_codec<Storage> codec(4);
+    numa_adaptor<Storage, StorageContainer> X(state.range(0), codec.encode(0), arena);
+    numa_adaptor<Storage, StorageContainer> Y(state.range(0), codec.encode(1), arena);
+
+    ValueType alpha = -2;
+
+    Partitioner part;
+
+    for (auto _ : state) {
+        arena.execute([&] (const int i) {
+            tbb::parallel_for(tbb::blocked_range<size_t>(X.get_range(i).first, X.get_range(i).second), [&] (const tbb::blocked_range<size_t> r) {
+                #pragma omp simd
+                for (auto j = r.begin(); j < r.end(); j++) {
+                    Y[j] = codec.encode(alpha * codec.decode(X[j]) + codec.decode(Y[j]));
+                }
+            }, part);
+        });
+    }
+
+    setStorageCounter(state, std::string("TransformStorage") + codec.name + "TbbNoInit", sizeof(Storage));
+}
+
+// Y = alpha * X + Y with X uncompressed 32 bit integers, the baseline of the
+// compressed transforms.
+static void benchTransformUncompressedTbbNoInit(benchmark::State& state) {
+    using WordContainer = std::vector<std::uint32_t, numa::no_init_allocator<std::uint32_t>>;
+    numa::ArenaMgtTBBV3 arena;
+    numa_adaptor<std::uint32_t, WordContainer> X(state.range(0), 0, arena);
+    numa_adaptor<ValueType, ContainerType> Y(state.range(0), 1, arena);
+    arena.execute([&] (const int i) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(X.get_range(i).first, X.get_range(i).second), [&] (const tbb::blocked_range<size_t> r) {
+            for (auto j = r.begin(); j < r.end(); j++) {
+                X[j] = static_cast<std::uint32_t>(numa::splitmix64(j));
+            }
+        });
+    });
+
+    ValueType alpha = -2;
+
+    Partitioner part;
+
+    for (auto _ : state) {
+        alpha = -alpha;
+        arena.execute([&, alpha] (const int i) {
+            tbb::parallel_for(tbb::blocked_range<size_t>(X.get_range(i).first, X.get_range(i).second), [&] (const tbb::blocked_range<size_t> r) {
+                #pragma omp simd
+                for (auto j = r.begin(); j < r.end(); j++) {
+                    Y[j] = alpha * static_cast<ValueType>(X[j]) + Y[j];
+                }
+            }, part);
+        });
+    }
+
+    setCompressedCounter(state, "TransformUncompressedTbbNoInit", state.range(0) * sizeof(std::uint32_t));
+}
+
+// Y = alpha * X + Y with X stored in compressed blocks of Format. Every block
+// of X is decoded row by row in registers and the rows are applied to Y right
+// away. A node transforms the blocks which start in its part of the
+// compressed words, the matching part of Y is on the same node up to the
+// block at the boundary.
+template <typename Format>
+static void benchTransformCompressedTbbNoInit(benchmark::State& state) {
+    using WordContainer = std::vector<std::uint32_t, numa::no_init_allocator<std::uint32_t>>;
+    const size_t blocks = state.range(0) / numa::block_size;
+    numa::ArenaMgtTBBV3 arena;
+    numa_adaptor<std::uint32_t, WordContainer> X(blocks * Format::block_words, 0, arena);
+    numa_adaptor<ValueType, ContainerType> Y(state.range(0), 1, arena);
+
+    // encode the blocks on the nodes which hold them
+    arena.execute([&] (const int i) {
+        auto [first, last] = numa::block_range(X.get_range(i), Format::block_words);
+        tbb::parallel_for(tbb::blocked_range<size_t>(first, last), [&] (const tbb::blocked_range<size_t> r) {
+            std::uint32_t values[numa::block_size];
+            for (auto b = r.begin(); b < r.end(); b++) {
+                Format::example_block(b, values);
+                Format::encode(values, X.data() + b * Format::block_words);
+            }
+        });
+    });
+
+    ValueType alpha = -2;
+
+    Partitioner part;
+
+    for (auto _ : state) {
+        alpha = -alpha;
+        arena.execute([&, alpha] (const int i) {
+            auto [first, last] = numa::block_range(X.get_range(i), Format::block_words);
+            tbb::parallel_for(tbb::blocked_range<size_t>(first, last), [&] (const tbb::blocked_range<size_t> r) {
+                for (auto b = r.begin(); b < r.end(); b++) {
+                    ValueType* y = Y.data() + b * numa::block_size;
+                    Format::decode(X.data() + b * Format::block_words, [&] (size_t k, const std::uint32_t* row) {
+                        #pragma omp simd
+                        for (size_t l = 0; l < numa::block_lanes; l++) {
+                            y[k * numa::block_lanes + l] = alpha * static_cast<ValueType>(row[l]) + y[k * numa::block_lanes + l];
+                        }
+                    });
+                }
+            }, part);
+        });
+    }
+
+    setCompressedCounter(state, "TransformCompressed" + Format::name() + "TbbNoInit",
+                         blocks * Format::block_words * sizeof(std::uint32_t));
+}
+
+// streamStep over [first, last) with streaming stores of the output array
+template <StreamKernel Kernel>
+void streamRangeStreaming(ValueType* A, ValueType* B, ValueType* C, size_t first, size_t last) {
+    constexpr ValueType scalar = 3;
+    const size_t n = last - first;
+    if constexpr (Kernel == StreamKernel::copy) {
+        numa::stream_transform(A + first, A + first, C + first, n, [] (ValueType a, ValueType) { return a; });
+    } else if constexpr (Kernel == StreamKernel::scale) {
+        numa::stream_transform(C + first, C + first, B + first, n, [] (ValueType c, ValueType) { return scalar * c; });
+    } else if constexpr (Kernel == StreamKernel::add) {
+        numa::stream_transform(A + first, B + first, C + first, n, [] (ValueType a, ValueType b) { return a + b; });
+    } else {
+        numa::stream_transform(B + first, C + first, A + first, n, [] (ValueType b, ValueType c) { return b + scalar * c; });
+    }
+}
+
+template <StreamKernel Kernel, StoreMode Mode = StoreMode::cached>
+static void benchStreamOmpNoInit(benchmark::State& state) {
+    numa_adaptor<ValueType, ContainerType> A(state.range(0), 1, numa_nodes);
+    numa_adaptor<ValueType, ContainerType> B(state.range(0), 2, numa_nodes);
+    numa_adaptor<ValueType, ContainerType> C(state.range(0), 3, numa_nodes);
+    const bool streaming = useStreaming(Mode, streamArrays(Kernel) * A.size() * sizeof(ValueType));
+
+    for (auto _ : state) {
+        if (streaming) {
+            #pragma omp parallel
+            {
+                auto [first, last] = threadRange(A.size());
+                streamRangeStreaming<Kernel>(A.data(), B.data(), C.data(), first, last);
+            }
+        } else {
+            #pragma omp parallel for simd
+            for (size_t j = 0; j < A.size(); j++) {
+                streamStep<Kernel>(A, B, C, j);
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+
+    setStreamCounter(state, std::string("Stream") + streamKernelName(Kernel) + "Omp" + storeModeName(Mode) + "NoInit", streamArrays(Kernel), streaming);
+    state.counters["StreamingStores"] = streaming;
+}
+
+template <StreamKernel Kernel>
+static void benchStreamTbbNoInit(benchmark::State& state) {
+    numa::ArenaMgtTBBV3 arena;
+    numa_adaptor<ValueType, ContainerType> A(state.range(0), 1, arena);
+    numa_adaptor<ValueType, ContainerType> B(state.range(0), 2, arena);
+    numa_adaptor<ValueType, ContainerType> C(state.range(0), 3, arena);
+
+    Partitioner part;
+
+    for (auto _ : state) {
+        arena.execute([&] (const int i) {
+            tbb::parallel_for(tbb::blocked_range<size_t>(A.get_range(i).first, A.get_range(i).second), [&] (const tbb::blocked_range<size_t> r) {
+                #pragma omp simd
+                for (auto j = r.begin(); j < r.end(); j++) {
+                    streamStep<Kernel>(A, B, C, j);
+                }
+            }, part);
+        });
+    }
+
+    setStreamCounter(state, std::string("Stream") + streamKernelName(Kernel) + "TbbNoInit", streamArrays(Kernel), false);
+}
+
+// X[j] = a chain of Fmas multiply-adds x = x * a + b on X[j]. Every element
+// is read and written once (2 * sizeof(ValueType) bytes) and costs 2 * Fmas
+// flops, so the arithmetic intensity grows with Fmas. The rome build fuses
+// the multiply-adds (-mfma), the qdr build has no FMA instructions and uses a
+// multiply and an add. a = b = 0.5 keep X = 1 exact.
+//
+// The chain of a single element is bound by the latency of the FMA, not by
+// its throughput. fmaChains therefore works on blocks of fmaBlock elements
+// with fmaChainCount independent chains per SIMD lane, which covers the
+// latency (4 to 5 cycles) times the FMA pipes (2) of the cores.
+static constexpr size_t fmaChainCount = 10;
+static constexpr size_t fmaWidth = 16;
+static constexpr size_t fmaBlock = fmaChainCount * fmaWidth;
+
+template <int Fmas>
+inline ValueType fmaChain(ValueType x, ValueType a, ValueType b) {
+    for (int k = 0; k < Fmas; k++) {
+        x = x * a + b;
+    }
+    return x;
+}
+
+// the chains of the fmaBlock elements starting at x, chain c of lane l is
+// x[l + c * fmaWidth]
+template <int Fmas>
+inline void fmaChains(ValueType* x, ValueType a, ValueType b) {
+    #pragma omp simd
+    for (size_t l = 0; l < fmaWidth; l++) {
+        ValueType v[fmaChainCount];
+        for (size_t c = 0; c < fmaChainCount; c++) {
+            v[c] = x[l + c * fmaWidth];
+        }
+        for (int k = 0; k < Fmas; k++) {
+            for (size_t c = 0; c < fmaChainCount; c++) {
+                v[c] = v[c] * a + b;
+            }
+        }
+        for (size_t c = 0; c < fmaChainCount; c++) {
+            x[l + c * fmaWidth] = v[c];
+        }
+    }
+}
+
+void setFmaCounter(benchmark::State& state, std::string name, int fmas) {
+    const double bytes = 2 * state.range(0) * sizeof(ValueType);
+    const double flops = 2.0 * fmas * state.range(0);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * 2 * state.range(0) * sizeof(ValueType));
+    state.counters["Elements"] = state.range(0);
+    state.counters["Bytes"] = bytes;
+    state.counters["Fmas"] = fmas;
+    state.counters["ArithmeticIntensity"] = flops / bytes;
+    state.counters["Flops"] = benchmark::Counter(state.iterations() * flops, benchmark::Counter::kIsRate);
+    state.SetLabel(name);
+}
+
+template <int Fmas>
+static void benchFmaOmpNoInit(benchmark::State& state) {
+    numa_adaptor<ValueType, ContainerType> X(state.range(0), 1, numa_nodes);
+    ValueType a = 0.5;
+    ValueType b = 0.5;
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(b);
+
+    const size_t blocks = X.size() / fmaBlock;
+
+    for (auto _ : state) {
+        #pragma omp parallel for
+        for (size_t i = 0; i < blocks; i++) {
+            fmaChains<Fmas>(X.data() + i * fmaBlock, a, b);
+        }
+        for (size_t j = blocks * fmaBlock; j < X.size(); j++) {
+            X[j] = fmaChain<Fmas>(X[j], a, b);
+        }
+        benchmark::ClobberMemory();
+    }
+
+    setFmaCounter(state, "FmaOmpNoInit" + std::to_string(Fmas), Fmas);
+}
+
+// The compute roof of the roofline: every thread runs fmaChains with
+// fmaPeakFmas multiply-adds on a block in its registers, without any memory
+// traffic.
+static constexpr int fmaPeakFmas = 1 << 16;
+
+static void benchFmaPeakOmpNoInit(benchmark::State& state) {
+    ValueType a = 0.5;
+    ValueType b = 0.5;
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(b);
+
+    int threads = 1;
+    for (auto _ : state) {
+        #pragma omp parallel
+        {
+            alignas(64) ValueType x[fmaBlock];
+            std::fill(x, x + fmaBlock, ValueType(1));
+            fmaChains<fmaPeakFmas>(x, a, b);
+            benchmark::DoNotOptimize(x);
+            #pragma omp master
+            threads = omp_get_num_threads();
+        }
+    }
+
+    const double flops = 2.0 * fmaPeakFmas * fmaBlock * threads;
+    state.counters["Threads"] = threads;
+    state.counters["Flops"] = benchmark::Counter(state.iterations() * flops, benchmark::Counter::kIsRate);
+    state.SetLabel("FmaPeakOmpNoInit");
+}
+
 BENCHMARK(benchTransformOmpNoInit)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformOmpStoreNoInit, StoreMode::cached)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformOmpStoreNoInit, StoreMode::streaming)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformOmpStoreNoInit, StoreMode::automatic)->Apply(Args)->UseRealTime();
 BENCHMARK(benchTransformOmpNoInit2)->Apply(Args)->UseRealTime();
 BENCHMARK(benchTransformOmpNestingNoInit)->Apply(Args)->UseRealTime();
 BENCHMARK(benchTransformOmpNestingNoInit2)->Apply(Args)->UseRealTime();
 BENCHMARK(benchTransformTbbNoInit)->Apply(Args)->UseRealTime();
 BENCHMARK(benchTransformTbbNoInit2)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformStorageTbbNoInit, float)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformStorageTbbNoInit, numa::bfloat16)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformStorageTbbNoInit, numa::float16)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformStorageTbbNoInit, numa::int16_scaled)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformStorageTbbNoInit, numa::int8_scaled)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchStreamOmpNoInit, StreamKernel::copy)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchStreamOmpNoInit, StreamKernel::scale)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchStreamOmpNoInit, StreamKernel::add)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchStreamOmpNoInit, StreamKernel::triad)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE2(benchStreamOmpNoInit, StreamKernel::copy, StoreMode::streaming)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE2(benchStreamOmpNoInit, StreamKernel::scale, StoreMode::streaming)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE2(benchStreamOmpNoInit, StreamKernel::add, StoreMode::streaming)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE2(benchStreamOmpNoInit, StreamKernel::triad, StoreMode::streaming)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE2(benchStreamOmpNoInit, StreamKernel::copy, StoreMode::automatic)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE2(benchStreamOmpNoInit, StreamKernel::scale, StoreMode::automatic)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE2(benchStreamOmpNoInit, StreamKernel::add, StoreMode::automatic)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE2(benchStreamOmpNoInit, StreamKernel::triad, StoreMode::automatic)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchStreamTbbNoInit, StreamKernel::copy)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchStreamTbbNoInit, StreamKernel::scale)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchStreamTbbNoInit, StreamKernel::add)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchStreamTbbNoInit, StreamKernel::triad)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchFmaOmpNoInit, 1)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchFmaOmpNoInit, 2)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchFmaOmpNoInit, 4)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchFmaOmpNoInit, 8)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchFmaOmpNoInit, 16)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchFmaOmpNoInit, 32)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchFmaOmpNoInit, 64)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchFmaOmpNoInit, 128)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchFmaOmpNoInit, 256)->Apply(Args)->UseRealTime();
+BENCHMARK(benchFmaPeakOmpNoInit)->UseRealTime();
+BENCHMARK(benchTransformUncompressedTbbNoInit)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::bitpacked_format<4>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::bitpacked_format<8>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::bitpacked_format<12>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::bitpacked_format<16>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::bitpacked_format<24>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::delta_for_format<4>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::delta_for_format<8>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::delta_for_format<12>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::delta_for_format<16>)->Apply(Args)->UseRealTime();
+BENCHMARK_TEMPLATE(benchTransformCompressedTbbNoInit, numa::delta_for_format<24>)->Apply(Args)->UseRealTime();
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,181 @@
+import argparse
+import csv
+import re
+
+import matplotlib.pyplot as plt
+import numpy as np
+
+# Empirical roofline of the fma kernel (transform with --transform_kernel fma,
+# benchFmaOmpNoInit of numa_v1). The memory roof is the measured STREAM
+# bandwidth at the largest vector size, where the vectors do not fit into the
+# caches. The compute roof is the peak kernel, which runs independent chains
+# of multiply-adds in registers (Peak Performance of the HPX fma run, summed
+# up over the localities, or benchFmaPeakOmpNoInit of numa_v1), unless a
+# theoretical peak is given with --peak.
+#
+# HPX:     python3 roofline.py --hpx fma_rome.txt --stream stream_rome.txt --cluster rome
+# numa_v1: python3 roofline.py --csv transform_rome1.csv --cluster rome
+
+patternForScientificNumbers = r'([+\-]?(?:0|[1-9]\d*)(?:\.\d+)?(?:[eE][+\-]?\d+)?)'
+
+def extractHpxRuns(lines):
+	# list of (vector size, kernel, {name: [values of all localities]})
+	runs = []
+	for line in lines:
+		match = re.match(r'Transform Vector Size: (\S+)', line)
+		if match:
+			runs.append([float(match.group(1)), "inplace", {}])
+			continue
+		if not runs:
+			continue
+		match = re.match(r'Transform Kernel: (\S+)', line)
+		if match:
+			runs[-1][1] = match.group(1)
+			continue
+		match = re.match(r'(FMA Count|Arithmetic Intensity|Performance|Peak Performance|Bandwidth) == ' + patternForScientificNumbers, line)
+		if match:
+			runs[-1][2].setdefault(match.group(1), []).append(float(match.group(2)))
+	return runs
+
+def largestRun(runs, kernel):
+	selected = [run for run in runs if run[1] == kernel]
+	if len(selected) == 0:
+		raise ValueError("No " + kernel + " runs found")
+	return max(selected, key=lambda run: run[0])
+
+def hpxFmaPoints(fileName):
+	with open(fileName, "r") as file:
+		run = largestRun(extractHpxRuns(file.readlines()), "fma")
+	values = run[2]
+	# every locality prints the values of every FMA count in turn, the
+	# slowest locality counts
+	counts = values["FMA Count"]
+	intensities = values["Arithmetic Intensity"]
+	performances = values["Performance"]
+	points = {}
+	for count, intensity, performance in zip(counts, intensities, performances):
+		if count not in points or performance < points[count][1]:
+			points[count] = (intensity, performance)
+	return [points[count] for count in sorted(points)]
+
+def hpxFmaPeak(fileName):
+	# every locality measures the peak of its own worker threads
+	with open(fileName, "r") as file:
+		run = largestRun(extractHpxRuns(file.readlines()), "fma")
+	if "Peak Performance" not in run[2]:
+		return None
+	return sum(run[2]["Peak Performance"])
+
+def hpxStreamBandwidth(fileName, kernel):
+	with open(fileName, "r") as file:
+		run = largestRun(extractHpxRuns(file.readlines()), kernel)
+	return min(run[2]["Bandwidth"])
+
+def readCsvRows(fileName):
+	with open(fileName, "r") as file:
+		lines = file.readlines()
+	# google benchmark writes its context in front of the table
+	for i, line in enumerate(lines):
+		if line.startswith("name,"):
+			return list(csv.DictReader(lines[i:]))
+	raise ValueError("No benchmark table found in " + fileName)
+
+def csvSize(row):
+	return int(row["name"].split("/")[1])
+
+def csvMeasurements(rows, prefix):
+	# the means of the repetitions if there are aggregates, the plain rows
+	# otherwise
+	selected = [row for row in rows if row["name"].startswith(prefix)]
+	means = [row for row in selected if row["name"].endswith("_mean")]
+	if len(means) > 0:
+		return means
+	return [row for row in selected if not re.search(r'_(mean|median|stddev|cv)$', row["name"])]
+
+def largestSizeRows(rows, prefix):
+	measurements = csvMeasurements(rows, prefix)
+	if len(measurements) == 0:
+		raise ValueError("No " + prefix + " rows found")
+	size = max(csvSize(row) for row in measurements)
+	return [row for row in measurements if csvSize(row) == size]
+
+def csvFmaPoints(rows):
+	return sorted((float(row["ArithmeticIntensity"]), float(row["Flops"]) * 1e-9)
+	              for row in largestSizeRows(rows, "benchFmaOmpNoInit<"))
+
+def csvFmaPeak(rows):
+	measurements = csvMeasurements(rows, "benchFmaPeakOmpNoInit")
+	if len(measurements) == 0:
+		return None
+	return max(float(row["Flops"]) * 1e-9 for row in measurements)
+
+def csvStreamBandwidth(rows, kernel):
+	prefix = "benchStreamOmpNoInit<StreamKernel::" + kernel + ">/"
+	return max(float(row["bytes_per_second"]) * 1e-9 for row in largestSizeRows(rows, prefix))
+
+def plottingRoofline(points, bandwidth, peak, clusterName, fileName):
+	intensities = [point[0] for point in points]
+	performances = [point[1] for point in points]
+	ridge = peak / bandwidth
+
+	plt.figure(figsize=(16, 9))
+	plt.xticks(fontsize=14, rotation=0)
+	plt.tick_params(axis='x', which='both', direction='in', length=8, width=1.5)
+	plt.yticks(fontsize=14)
+	plt.tick_params(axis='y', which='both', direction='in', length=8, width=1.5)
+	plt.title(("Roofline on " + clusterName.capitalize()), fontsize=20)
+	plt.xscale("log", base=2)
+	plt.yscale("log", base=10)
+	plt.xlabel("Arithmetic intensity [flop/byte]", fontsize=14)
+	plt.ylabel("Performance [GFLOP/s]", fontsize=14)
+	plt.grid()
+
+	x = np.logspace(np.log2(min(intensities) / 2), np.log2(max(intensities) * 2), 200, base=2)
+	plt.plot(x, np.minimum(peak, bandwidth * x), color='black',
+			 label=("Roof: %.1f GB/s, %.1f GFLOP/s, ridge at %.2f flop/byte" % (bandwidth, peak, ridge)))
+	plt.plot(intensities,
+			 performances,
+			 marker='o',
+			 linestyle='none',
+			 label="fma kernel")
+
+	plt.legend(fontsize=14)
+	plt.savefig(fileName, dpi=400)
+
+	# the report: where the kernel stops being bound by the bandwidth
+	print("Memory roof:", bandwidth, "GB/s")
+	print("Compute roof:", peak, "GFLOP/s")
+	print("Ridge point:", ridge, "flop/byte")
+	for intensity, performance in zip(intensities, performances):
+		roof = min(peak, bandwidth * intensity)
+		bound = "memory" if intensity < ridge else "compute"
+		print("%8.3f flop/byte  %10.2f GFLOP/s  %5.1f %% of roof  %s bound" %
+			  (intensity, performance, 100 * performance / roof, bound))
+
+parser = argparse.ArgumentParser(description="Empirical roofline of the fma kernel")
+parser.add_argument("--hpx", help="output of the HPX transform with --transform_kernel fma")
+parser.add_argument("--stream", help="output of the HPX transform with a STREAM kernel")
+parser.add_argument("--csv", help="numa_v1 transform benchmark csv with the Fma and Stream benchmarks")
+parser.add_argument("--kernel", default="triad", help="STREAM kernel of the memory roof")
+parser.add_argument("--peak", type=float, help="compute roof [GFLOP/s], the measured peak kernel by default")
+parser.add_argument("--cluster", default="rome")
+arguments = parser.parse_args()
+
+if arguments.csv:
+	rows = readCsvRows(arguments.csv)
+	points = csvFmaPoints(rows)
+	bandwidth = csvStreamBandwidth(rows, arguments.kernel)
+	measuredPeak = csvFmaPeak(rows)
+elif arguments.hpx and arguments.stream:
+	points = hpxFmaPoints(arguments.hpx)
+	bandwidth = hpxStreamBandwidth(arguments.stream, arguments.kernel)
+	measuredPeak = hpxFmaPeak(arguments.hpx)
+else:
+	parser.error("either --csv or --hpx and --stream are required")
+
+# the fma points themselves are no compute roof, they are what is measured
+# against it
+peak = arguments.peak if arguments.peak else measuredPeak
+if peak is None:
+	parser.error("no peak kernel in the measurements, --peak is required")
+plottingRoofline(points, bandwidth, peak, arguments.cluster, "roofline" + arguments.cluster.capitalize() + ".png")